@@ -7,9 +7,11 @@
 #define POD_API __cdecl
 
 #ifdef __cplusplus
+#include <cstddef>
 #include <cstdint>
 extern "C" {
 #else
+#include <stddef.h>
 #include <stdint.h>
 #endif
 
@@ -19,6 +21,15 @@ typedef void pod_item_t;
 // A container of pod_item(s)
 typedef struct pod_container_t pod_container_t;
 
+// A file that items are written to one at a time
+typedef struct pod_writer_t pod_writer_t;
+
+// A save that runs on a background thread
+typedef struct pod_save_t pod_save_t;
+
+// A key with its hash computed ahead of time, for looking up the same key repeatedly
+typedef struct pod_key_t pod_key_t;
+
 // Result of pod-io functions
 typedef enum pod_result_t : uint32_t
 {
@@ -81,14 +92,77 @@ typedef enum pod_checksum_t : uint32_t
     POD_CHECKSUM_NONE          = 0u,          // Read/write a file with no checksum
     POD_CHECKSUM_ADLER32       = 1u,          // Read/write a file with an adler32 checksum
     POD_CHECKSUM_CRC32         = 2u,          // Read/write a file with a crc32 checksum
+    POD_CHECKSUM_CRC32C        = 3u,          // Read/write a file with a crc32c (Castagnoli) checksum, computed in hardware where available
 } pod_checksum_t;
 
+// Codec
+typedef enum pod_codec_t : uint32_t
+{
+    POD_CODEC_DEFLATE          = 0u,          // Compress with DEFLATE (zlib)
+    POD_CODEC_LZ               = 1u,          // Compress with the built-in LZ codec (faster, larger files)
+} pod_codec_t;
+
+// Format Options
+typedef enum pod_flags_t : uint32_t
+{
+    POD_FLAGS_NONE             = 0x00000000u, // Save the file in the default format
+    POD_FLAGS_INDEX            = 0x00000001u, // Store a block index in the trailer (see pod_load_items)
+    POD_FLAGS_FILTER           = 0x00000002u, // Apply the filter of each item to its values (see pod_set_filter)
+    POD_FLAGS_APPEND           = 0x00000004u, // Allow segments to be appended to the file, implies POD_FLAGS_INDEX (see pod_append_file)
+    POD_FLAGS_COUNT64          = 0x00000008u, // Store value counts with 64 bits, added automatically when an item has more than 2^32 - 1 values
+    POD_FLAGS_ALIGN            = 0x00000010u, // Pad blocks so the values of uncompressed files start at 64 byte aligned file offsets (see pod_map_file)
+    POD_FLAGS_BLOCK_CHECKSUM   = 0x00000020u, // Store a checksum of every block in the index, implies POD_FLAGS_INDEX (see pod_salvage_file)
+} pod_flags_t;
+
+// Filters
+// A shuffle filter can be combined with a transform using bitwise OR
+// Transforms treat values as unsigned integers of the same size, so they are lossless for every type
+typedef enum pod_filter_t : uint32_t
+{
+    POD_FILTER_NONE            = 0x00000000u, // Values are compressed as they are
+    POD_FILTER_SHUFFLE         = 0x00000001u, // Group byte n of every value together before compressing
+    POD_FILTER_BITSHUFFLE      = 0x00000002u, // Group bit n of every value together before compressing
+    POD_FILTER_DELTA           = 0x00000100u, // Store the difference from the previous value (for integers)
+    POD_FILTER_DELTA2          = 0x00000200u, // Store the difference from the previous delta (for evenly spaced integers, such as timestamps)
+    POD_FILTER_XOR             = 0x00000300u, // Store the XOR with the previous value (for floating point numbers)
+} pod_filter_t;
+
 // Create a container
 pod_container_t* POD_API pod_alloc();
 
 // Delete a container
 void POD_API pod_free(pod_container_t* container);
 
+// Make room for a number of items in a container, so that adding them doesn't grow its lookup table
+// Item handles stay valid when the container grows, until their item is removed.
+// returns POD_OUT_OF_RANGE if the memory can't be allocated
+pod_result_t POD_API pod_reserve(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    size_t                   itemCount);      // Number of items
+
+// Set the number of threads used to compress files, and to inflate files saved with POD_FLAGS_INDEX
+// 0 uses one thread per hardware thread, 1 (the default) uses only the calling thread.
+// The setting is global and applies to every save that starts after it is set.
+pod_result_t POD_API pod_set_thread_count(
+    uint32_t                 count);          // Number of threads
+
+// Set the size of the chunks that files are read and written in
+// Files are read one chunk ahead of inflating them, and written one chunk behind deflating them,
+// on a background thread, so disk time overlaps with compression.
+// Larger chunks suit fast disks and network filesystems, and 0 reads and writes on the calling thread.
+// The default is 4 MiB. Files in memory and pod_stream_t streams are always read and written on the calling thread.
+// The setting is global and applies to every save or load that starts after it is set.
+// returns POD_OUT_OF_RANGE if size is larger than 1 GiB
+pod_result_t POD_API pod_set_io_buffer_size(
+    uint64_t                 size);           // Chunk size in bytes
+
+// Set whether items keep their compressed block after a save with POD_FLAGS_INDEX (see pod_save_file_ex)
+// Kept blocks make saving unchanged items cheap, but hold a compressed copy of every item in memory.
+// 0 (the default) doesn't keep blocks, and drops the blocks of items in the containers that are saved next.
+// The setting is global and applies to every save that starts after it is set.
+pod_result_t POD_API pod_set_block_cache(
+    uint32_t                 enabled);        // 1 to keep blocks, 0 to not keep them
+
 // Load a file into a container
 // If checksum is NONE, then checksumValue isn't used.
 // If checksum is not NONE, then checksumValue must be
@@ -99,6 +173,15 @@ pod_result_t POD_API pod_load_file(
     pod_checksum_t           checksum,        // Checksum type
     uint32_t                 checksumValue);  // Initial checksum value
 
+// Verify the checksum of a file without loading it
+// The bytes are read and checksummed as they are stored, so nothing is inflated.
+// Files saved with POD_CHECKSUM_NONE only have their header checked.
+// returns POD_FILE_CORRUPT if the checksum doesn't match, or if the file was saved with a different checksum type
+pod_result_t POD_API pod_verify_file(
+    const char*              fileName,        // File name
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue);  // Initial checksum value
+
 // Save a file using data stored in the container
 // If checksum is NONE, then checksumValue isn't used.
 // If checksum is not NONE, then checksumValue must be
@@ -111,6 +194,289 @@ pod_result_t POD_API pod_save_file(
     uint32_t                 checksumValue,   // Initial checksum value
     pod_endian_t             endianness);
 
+// Save a file using data stored in the container
+// with additional format options
+// POD_COMPRESSION_0 stores the values without any codec framing (see pod_map_file).
+// POD_CODEC_LZ ignores other compression levels.
+// With POD_FLAGS_INDEX and pod_set_block_cache, items keep their compressed block so that items which haven't been set
+// are copied instead of compressed again when the container is saved with the same options.
+// Files saved with flags other than POD_FLAGS_NONE, with POD_COMPRESSION_0, or with POD_CODEC_LZ
+// can't be read by versions of pod-io that predate pod_save_file_ex.
+pod_result_t POD_API pod_save_file_ex(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              fileName,        // File name
+    pod_compression_t        compression,     // Compression level
+    pod_codec_t              codec,           // Codec
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_endian_t             endianness,      // Endianness
+    pod_flags_t              flags);          // Bitwise OR of pod_flags_t options
+
+// Save a file on a background thread, with the same options as pod_save_file_ex
+// The container is copied before the call returns, without copying its values:
+// the copy shares them, and items that are set afterwards get new values instead of changing the shared ones,
+// so the container can be changed or freed while the file is written.
+// Lazy items are inflated before the call returns.
+// Compressed blocks aren't kept for the next save of the container (see pod_save_file_ex).
+// On success, save must be passed to pod_save_wait.
+// returns POD_OUT_OF_RANGE if the copy or the thread can't be allocated
+pod_result_t POD_API pod_save_file_async(
+    pod_save_t**             save,            // Returned save
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              fileName,        // File name
+    pod_compression_t        compression,     // Compression level
+    pod_codec_t              codec,           // Codec
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_endian_t             endianness,      // Endianness
+    pod_flags_t              flags);          // Bitwise OR of pod_flags_t options
+
+// Check if a save started by pod_save_file_async has finished, without waiting for it
+pod_result_t POD_API pod_save_poll(
+    pod_save_t*              save,            // Handle to a valid pod_save_t
+    uint32_t*                finished);       // Returned 1 if the save has finished, otherwise 0
+
+// Wait for a save started by pod_save_file_async to finish, then free save
+// returns the result of the save
+pod_result_t POD_API pod_save_wait(
+    pod_save_t*              save);           // Handle to a valid pod_save_t
+
+// Append the items of a container to a file saved with POD_FLAGS_APPEND
+// The items are written as a new segment at the end of the file, without rewriting the existing blocks,
+// and replace items with the same keys in earlier segments when the file is loaded.
+// The codec, endianness, and flags of the file are kept, and compression only applies to DEFLATE files.
+// returns POD_ARGUMENT_ERROR if the file wasn't saved with POD_FLAGS_APPEND
+// returns POD_OUT_OF_RANGE if an item has more than 2^32 - 1 values and the file wasn't saved with POD_FLAGS_COUNT64
+pod_result_t POD_API pod_append_file(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              fileName,        // File name
+    pod_compression_t        compression,     // Compression level
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue);  // Initial checksum value
+
+// Rewrite a file as a single segment
+// Blocks replaced by appended segments are dropped, and the file keeps its format options.
+// The values are inflated one item at a time, so the whole file is never held in memory
+// when it was saved with POD_FLAGS_INDEX.
+pod_result_t POD_API pod_compact_file(
+    const char*              fileName,        // File name
+    pod_compression_t        compression,     // Compression level
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue);  // Initial checksum value
+
+// Save a container to a buffer in memory instead of a file
+// The buffer holds the same bytes that pod_save_file_ex writes, and is allocated by pod-io.
+// On success, buffer must be freed with pod_free_memory.
+pod_result_t POD_API pod_save_memory(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    void**                   buffer,          // Returned buffer
+    uint64_t*                size,            // Returned size of the buffer in bytes
+    pod_compression_t        compression,     // Compression level
+    pod_codec_t              codec,           // Codec
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_endian_t             endianness,      // Endianness
+    pod_flags_t              flags);          // Bitwise OR of pod_flags_t options
+
+// Save a container to a buffer owned by the caller
+// size is set to the number of bytes the container needs, even if they don't fit in the buffer,
+// and a null buffer with a capacity of 0 only returns the size.
+// returns POD_OUT_OF_RANGE if the size exceeds the capacity of the buffer
+pod_result_t POD_API pod_save_memory_into(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    void*                    buffer,          // Buffer to save to
+    uint64_t                 capacity,        // Size of the buffer in bytes
+    uint64_t*                size,            // Returned number of bytes needed
+    pod_compression_t        compression,     // Compression level
+    pod_codec_t              codec,           // Codec
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_endian_t             endianness,      // Endianness
+    pod_flags_t              flags);          // Bitwise OR of pod_flags_t options
+
+// Free a buffer returned by pod_save_memory
+void POD_API pod_free_memory(
+    void*                    buffer);         // Buffer returned by pod_save_memory
+
+// Load a container from a buffer in memory
+// The buffer holds the bytes of a file, and isn't referenced after the call returns.
+pod_result_t POD_API pod_load_memory(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const void*              buffer,          // Buffer to load from
+    uint64_t                 size,            // Size of the buffer in bytes
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue);  // Initial checksum value
+
+// Callbacks that read or write a stream in place of a file
+// Streams are written in order from the start, without seeking, and any buffer size can be passed.
+// Loading a file saved with POD_FLAGS_INDEX or POD_COMPRESSION_0 also needs seek and size,
+// and the other callbacks can be null if the stream is only used in one direction.
+typedef struct pod_stream_t
+{
+    // Read up to size bytes into buffer
+    // returns the number of bytes read, which is 0 at the end of the stream
+    uint64_t (POD_API *read)(void* user, void* buffer, uint64_t size);
+
+    // Write size bytes from buffer
+    // returns the number of bytes written, which is less than size on failure
+    uint64_t (POD_API *write)(void* user, const void* buffer, uint64_t size);
+
+    // Move to an absolute byte offset
+    // returns 0 on success
+    int32_t (POD_API *seek)(void* user, uint64_t offset);
+
+    // Returns the size of the stream in bytes
+    uint64_t (POD_API *size)(void* user);
+
+    // User pointer passed to the callbacks
+    void* user;
+} pod_stream_t;
+
+// Save a container to a stream
+// The stream receives the same bytes that pod_save_file_ex writes.
+// returns POD_FILE_NOT_FOUND if the stream has no write callback, or if a write fails
+pod_result_t POD_API pod_save_stream(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const pod_stream_t*      stream,          // Stream to write to
+    pod_compression_t        compression,     // Compression level
+    pod_codec_t              codec,           // Codec
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_endian_t             endianness,      // Endianness
+    pod_flags_t              flags);          // Bitwise OR of pod_flags_t options
+
+// Load a container from a stream
+// returns POD_ARGUMENT_ERROR if the file needs a stream that can seek (see pod_stream_t)
+pod_result_t POD_API pod_load_stream(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const pod_stream_t*      stream,          // Stream to read from
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue);  // Initial checksum value
+
+// Open a file to write items to without adding them to a container
+// Each item is deflated straight from the caller's values, so only one item is held in memory.
+// The options are the same as pod_save_file_ex.
+// On success, writer must be passed to pod_writer_close.
+pod_result_t POD_API pod_writer_open(
+    pod_writer_t**           writer,          // Returned writer
+    const char*              fileName,        // File name
+    pod_compression_t        compression,     // Compression level
+    pod_codec_t              codec,           // Codec
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_endian_t             endianness,      // Endianness
+    pod_flags_t              flags);          // Bitwise OR of pod_flags_t options
+
+// Write an item to a file opened by pod_writer_open
+// The values can be changed or freed as soon as the call returns.
+// returns POD_ARGUMENT_ERROR if the key has already been written
+// After any other error, the file is incomplete and every later call returns the same error.
+pod_result_t POD_API pod_writer_add_item(
+    pod_writer_t*            writer,          // Handle to a valid pod_writer_t
+    const char*              key,             // Null-terminated ASCII key
+    const void*              srcValueArray,   // Array of values to write
+    uint32_t                 valueCount,      // Number of values in the array
+    pod_type_t               valueType,       // Type of values in the array
+    pod_filter_t             filter);         // Filter to apply when the file has POD_FLAGS_FILTER
+
+// Write an item to a file opened by pod_writer_open, with a count that can exceed 32 bits
+// returns POD_OUT_OF_RANGE if the count doesn't fit in 32 bits and the writer wasn't opened with POD_FLAGS_COUNT64
+pod_result_t POD_API pod_writer_add_item_ex(
+    pod_writer_t*            writer,          // Handle to a valid pod_writer_t
+    const char*              key,             // Null-terminated ASCII key
+    const void*              srcValueArray,   // Array of values to write
+    size_t                   valueCount,      // Number of values in the array
+    pod_type_t               valueType,       // Type of values in the array
+    pod_filter_t             filter);         // Filter to apply when the file has POD_FLAGS_FILTER
+
+// Finish the file of a writer, and free the writer
+pod_result_t POD_API pod_writer_close(
+    pod_writer_t*            writer);         // Handle to a valid pod_writer_t
+
+// Called by pod_visit_file for every item in a file
+// values points to valueCount values of valueType, which are only valid until the callback returns.
+// Returning anything other than POD_SUCCESS stops the visit, and pod_visit_file returns the same result.
+typedef pod_result_t (POD_API *pod_visit_callback_t)(
+    const char*              key,             // Key, which is null-terminated but may also hold null characters
+    size_t                   keySize,         // Number of characters in the key
+    pod_type_t               valueType,       // Type of the values
+    size_t                   valueCount,      // Number of values
+    const void*              values,          // Decoded values in the byte order of the host
+    void*                    user);           // User pointer passed to pod_visit_file
+
+// Visit every item in a file without adding them to a container
+// The values of each item are inflated into a buffer that is reused for the next item,
+// so memory use only depends on the largest item.
+// Items are visited before the trailing checksum is validated at the end of the file,
+// but blocks of files saved with POD_FLAGS_BLOCK_CHECKSUM are validated before they are visited.
+pod_result_t POD_API pod_visit_file(
+    const char*              fileName,        // File name
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_visit_callback_t     callback,        // Function called for every item
+    void*                    user);           // User pointer passed to the callback
+
+// Called by pod_salvage_file for every item that is corrupt
+typedef void (POD_API *pod_salvage_callback_t)(
+    const char*              key,             // Key, which is null-terminated but may also hold null characters
+    size_t                   keySize,         // Number of characters in the key
+    void*                    user);           // User pointer passed to pod_salvage_file
+
+// Load every intact item of a file saved with POD_FLAGS_BLOCK_CHECKSUM
+// Each block is validated against its own checksum on the thread that inflates it,
+// and items with a corrupt block are passed to the callback instead of being loaded.
+// Items that were already in the container keep their values if their block is corrupt.
+// The header and the index must be intact, since they are needed to find the blocks.
+// returns POD_FILE_CORRUPT if any item is corrupt, once every intact item is loaded
+// returns POD_ARGUMENT_ERROR if the file wasn't saved with POD_FLAGS_BLOCK_CHECKSUM
+pod_result_t POD_API pod_salvage_file(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              fileName,        // File name
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    pod_salvage_callback_t   callback,        // Function called for every corrupt item, or null
+    void*                    user);           // User pointer passed to the callback
+
+// Load specific items from a file into a container
+// If the file was saved with POD_FLAGS_INDEX, then only the blocks
+// of the requested keys are inflated, otherwise the whole file is loaded.
+// Keys that don't exist in the file are skipped.
+// The trailing checksum is only validated when the whole file is loaded,
+// but the checksum type must match the file.
+// Blocks of files saved with POD_FLAGS_BLOCK_CHECKSUM are validated against their own checksum.
+pod_result_t POD_API pod_load_items(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              fileName,        // File name
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue,   // Initial checksum value
+    const char* const*       keys,            // Array of null-terminated ASCII keys
+    uint32_t                 keyCount);       // Number of keys in the array
+
+// Load a file into a container without inflating its values
+// If the file was saved with POD_FLAGS_INDEX, then only the index is read
+// and each item's values are inflated the first time they are copied or saved.
+// The file stays open until every lazy item is set, removed, or the container is freed.
+// Otherwise the whole file is loaded the same as pod_load_file.
+// The trailing checksum is only validated when the whole file is loaded,
+// but the checksum type must match the file.
+// Blocks of files saved with POD_FLAGS_BLOCK_CHECKSUM are validated against their own checksum.
+pod_result_t POD_API pod_load_file_lazy(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              fileName,        // File name
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue);  // Initial checksum value
+
+// Map a file into a container without copying its values
+// Files saved by pod_save_file_ex with POD_COMPRESSION_0 in the endianness of the host
+// are memory mapped, and items read their values directly from the mapping.
+// The mapping stays open until every mapped item is set, removed, or the container is freed.
+// Any other file is loaded the same as pod_load_file.
+pod_result_t POD_API pod_map_file(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              fileName,        // File name
+    pod_checksum_t           checksum,        // Checksum type
+    uint32_t                 checksumValue);  // Initial checksum value
+
 // Get an item from a container
 // If the item doesn't exist, then it will be created
 // returns nullptr if the key size exceeds available memory,
@@ -126,6 +492,47 @@ pod_item_t* POD_API pod_try_get_item(
     pod_container_t*         container,       // Handle to a valid pod_container_t
     const char*              key);            // Null-terminated ASCII key
 
+// Get an item from a container by a key of keySize characters, which doesn't need a null terminator
+// If the item doesn't exist, then it will be created
+// returns nullptr if the container is null, or if key is null and keySize isn't 0
+pod_item_t* POD_API pod_get_item_n(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              key,             // ASCII key
+    size_t                   keySize);        // Number of characters in the key
+
+// Get an item from a container by a key of keySize characters, which doesn't need a null terminator
+// If the item doesn't exist, or if the container is nullptr,
+// then it will return nullptr
+pod_item_t* POD_API pod_try_get_item_n(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const char*              key,             // ASCII key
+    size_t                   keySize);        // Number of characters in the key
+
+// Copy a key and compute its hash once, so that looking it up doesn't hash it again
+// A key can be used with any container, and must be freed with pod_free_key.
+// returns nullptr if key is null and keySize isn't 0, or if the key size exceeds 2^32 - 1
+pod_key_t* POD_API pod_intern_key(
+    const char*              key,             // ASCII key
+    size_t                   keySize);        // Number of characters in the key
+
+// Free a key returned by pod_intern_key
+void POD_API pod_free_key(
+    pod_key_t*               key);            // Key returned by pod_intern_key
+
+// Get an item from a container by an interned key, without hashing or allocating
+// If the item doesn't exist, then it will be created
+// returns nullptr if the container or key is null
+pod_item_t* POD_API pod_get_item_key(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const pod_key_t*         key);            // Key returned by pod_intern_key
+
+// Get an item from a container by an interned key, without hashing or allocating
+// If the item doesn't exist, or if the container or key is nullptr,
+// then it will return nullptr
+pod_item_t* POD_API pod_try_get_item_key(
+    pod_container_t*         container,       // Handle to a valid pod_container_t
+    const pod_key_t*         key);            // Key returned by pod_intern_key
+
 // Remove an item from the container
 // does nothing if the key doesn't exist
 pod_result_t POD_API pod_remove_item(
@@ -139,11 +546,37 @@ pod_result_t POD_API pod_set_values(
     uint32_t                 valueCount,      // Number of values in the array
     pod_type_t               valueType);      // Type of values in the array
 
+// Set the values in a block, with a count that can exceed 32 bits
+pod_result_t POD_API pod_set_values_ex(
+    pod_item_t*              item,            // Handle to a valid pod_item_t
+    const void*              srcValueArray,   // Array of values to set
+    size_t                   valueCount,      // Number of values in the array
+    pod_type_t               valueType);      // Type of values in the array
+
+// Set the filter of a block
+// Filters rearrange the values before they are compressed, which usually makes numeric arrays smaller.
+// The filter is only applied when the file is saved with POD_FLAGS_FILTER,
+// and items loaded from such files keep the filter of their block.
+pod_result_t POD_API pod_set_filter(
+    pod_item_t*              item,            // Handle to a valid pod_item_t
+    pod_filter_t             filter);         // Filter to apply when the values are saved
+
+// Get the filter of a block
+pod_result_t POD_API pod_try_get_filter(
+    const pod_item_t*        item,            // Handle to a valid pod_item_t
+    pod_filter_t*            filter);         // Returned filter
+
 // Count the number of values in a block
+// returns POD_OUT_OF_RANGE if the count doesn't fit in 32 bits (see pod_try_count_values_ex)
 pod_result_t POD_API pod_try_count_values(
     const pod_item_t*        item,            // Handle to a valid pod_item_t
     uint32_t*                valueCount);     // Returned number of values in the block
 
+// Count the number of values in a block, with a count that can exceed 32 bits
+pod_result_t POD_API pod_try_count_values_ex(
+    const pod_item_t*        item,            // Handle to a valid pod_item_t
+    size_t*                  valueCount);     // Returned number of values in the block
+
 // Get the data type of a block
 pod_result_t POD_API pod_try_get_type(
     const pod_item_t*           item,            // Handle to a valid pod_item_t
@@ -156,6 +589,23 @@ pod_result_t POD_API pod_try_copy_values(
     uint32_t                 valueCount,      // Number of values to copy
     pod_type_t               type);           // The type of the values being copied
 
+// Copy the values from a block into a destination array, with a count that can exceed 32 bits
+pod_result_t POD_API pod_try_copy_values_ex(
+    const pod_item_t*        item,            // Handle to a valid pod_item_t
+    void*                    dstValueArray,   // Array to copy values to
+    size_t                   valueCount,      // Number of values to copy
+    pod_type_t               type);           // The type of the values being copied
+
+// Get a pointer to the values in a block without copying them
+// The pointer is valid until the item is set or removed, or the container is freed.
+// Values aren't guaranteed to be aligned to the size of their type,
+// except for items mapped by pod_map_file from files saved with POD_FLAGS_ALIGN, which are aligned to 64 bytes.
+// Returns a null pointer if the block is empty
+pod_result_t POD_API pod_try_get_values(
+    const pod_item_t*        item,            // Handle to a valid pod_item_t
+    const void**             values,          // Returned pointer to the values
+    pod_type_t               type);           // The type of the values
+
 // Count the number of characters in an item's key
 pod_result_t POD_API pod_try_count_key_chars(
     const pod_item_t*        item,            // Handle to a valid pod_item_t
@@ -168,16 +618,15 @@ pod_result_t POD_API pod_try_copy_key(
     char*                    buffer,          // The buffer to copy the key to
     uint32_t                 charCount);      // The number of characters in the key
 
-// Get the first item in the container's current state
-// The order will change if items
-// are added or removed from the container.
+// Get the first item in the container
+// Items are in the order they were added, and loaded items in the order they are stored in the file.
 // Returns nullptr if there are no items in the container
 pod_item_t* POD_API pod_get_first_item(
     pod_container_t*         container);      // Handle to a valid pod_container_t
 
-// Get the next item in the container
-// The order will change if items
-// are added or removed from the container.
+// Get the next item in the container, in the order items were added
+// Removing other items doesn't change the order, but the next item
+// has to be fetched before removing the current one.
 // Returns nullptr if there are no more
 // item in the container.
 pod_item_t* POD_API pod_get_next_item(
@@ -0,0 +1,482 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_BLOCK_H
+#define POD_BLOCK_H
+
+#include "pod_io.h"
+#include "PodBytes.h"
+#include "PodChecksum.h"
+#include "PodTypes.h"
+#include "PodDeflate.h"
+#include "PodFilter.h"
+#include "PodHeader.h"
+#include "PodLookup.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Returns the size of the header at the start of a block
+inline size_t block_header_size(pod_flags_t flags)
+{
+    size_t size = ((flags & POD_FLAGS_COUNT64) != 0) ? 16 : 12;
+
+    return ((flags & POD_FLAGS_FILTER) != 0) ? size + 4 : size;
+}
+
+// Encode the header of a block at the start of buffer
+//    [4] key size
+//    [4] value count
+//    [4] type
+//    [4] filter (only if flags has POD_FLAGS_FILTER)
+// or with POD_FLAGS_COUNT64
+//    [4] key size
+//    [4] type
+//    [8] value count
+//    [4] filter (only if flags has POD_FLAGS_FILTER)
+template<bool reverse_bytes>
+void encode_block_header(std::vector<uint8_t>& buffer, uint32_t keySize, uint64_t valueCount, pod_type_t type, uint32_t filter, pod_flags_t flags)
+{
+    set_bytes<uint32_t, reverse_bytes>(buffer, keySize, 0, 4);
+
+    if ((flags & POD_FLAGS_COUNT64) != 0)
+    {
+        set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(type), 4, 4);
+        set_bytes<uint64_t, reverse_bytes>(buffer, valueCount, 8, 8);
+    }
+    else
+    {
+        set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(valueCount), 4, 4);
+        set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(type), 8, 4);
+    }
+
+    if ((flags & POD_FLAGS_FILTER) != 0)
+    {
+        set_bytes<uint32_t, reverse_bytes>(buffer, filter, block_header_size(flags) - 4, 4);
+    }
+}
+
+// Decode the header of a block at the start of buffer
+// filter is set to POD_FILTER_NONE unless flags has POD_FLAGS_FILTER
+// returns false if the header is corrupt
+template<bool reverse_bytes>
+bool decode_block_header(std::vector<uint8_t>& buffer, uint32_t& keySize, uint64_t& valueCount, pod_type_t& type, uint32_t& filter, pod_flags_t flags)
+{
+    uint32_t rawType;
+
+    get_bytes<uint32_t, reverse_bytes>(keySize, buffer, 0, 4);
+
+    if ((flags & POD_FLAGS_COUNT64) != 0)
+    {
+        get_bytes<uint32_t, reverse_bytes>(rawType, buffer, 4, 4);
+        get_bytes<uint64_t, reverse_bytes>(valueCount, buffer, 8, 8);
+    }
+    else
+    {
+        uint32_t count32;
+
+        get_bytes<uint32_t, reverse_bytes>(count32, buffer, 4, 4);
+        get_bytes<uint32_t, reverse_bytes>(rawType, buffer, 8, 4);
+
+        valueCount = count32;
+    }
+
+    if (!to_pod_type(rawType, type) || (valueCount > MaxCountLookup[size_of_type(type)]))
+    {
+        return false;
+    }
+
+    filter = POD_FILTER_NONE;
+
+    if ((flags & POD_FLAGS_FILTER) != 0)
+    {
+        get_bytes<uint32_t, reverse_bytes>(filter, buffer, block_header_size(flags) - 4, 4);
+
+        if (!is_valid_filter(filter))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Number of value bytes that are transformed or byte swapped at a time when deflating
+constexpr size_t cValueChunkSize = 1u << 20;
+
+// Copy count values of typeSize bytes, reversing the bytes of each value
+// dst can be the same as src
+inline void swap_values(uint8_t* dst, const uint8_t* src, size_t count, size_t typeSize)
+{
+    switch(typeSize)
+    {
+        case 2:
+            k13::byteswap<uint16_t>(reinterpret_cast<uint16_t*>(dst), reinterpret_cast<const uint16_t*>(src), count);
+            break;
+        case 4:
+            k13::byteswap<uint32_t>(reinterpret_cast<uint32_t*>(dst), reinterpret_cast<const uint32_t*>(src), count);
+            break;
+        case 8:
+            k13::byteswap<uint64_t>(reinterpret_cast<uint64_t*>(dst), reinterpret_cast<const uint64_t*>(src), count);
+            break;
+        default:
+            if (dst != src)
+            {
+                memcpy(dst, src, count * typeSize);
+            }
+            break;
+    }
+}
+
+// Transform and byte swap count values starting at first, in the form they are stored in the file
+// out must have room for count + 2 values, since transforms depend on the two values before first
+// returns a pointer to the prepared values in out
+template<bool reverse_bytes>
+uint8_t* prepare_values(uint32_t filter, const uint8_t* values, uint8_t* out, size_t first, size_t count, size_t typeSize)
+{
+    uint8_t* prepared = out;
+
+    // Transforms work on values in the byte order of the host
+
+    if (has_transform(filter))
+    {
+        size_t context = std::min<size_t>(first, 2);
+
+        apply_transform(filter, values + (first - context) * typeSize, out, count + context, typeSize);
+        prepared = out + context * typeSize;
+
+        if constexpr (reverse_bytes)
+        {
+            swap_values(prepared, prepared, count, typeSize);
+        }
+    }
+    else if constexpr (reverse_bytes)
+    {
+        swap_values(prepared, values + first * typeSize, count, typeSize);
+    }
+    else
+    {
+        memcpy(prepared, values + first * typeSize, count * typeSize);
+    }
+
+    return prepared;
+}
+
+// Deflate the values of a block
+// returns COMPRESS_SUCCESS on success
+// and COMPRESS_ERROR on failure
+template<bool reverse_bytes>
+compress_result deflate_block_values(compress_stream& cs, std::vector<uint8_t>& buffer, const PodData& data, uint32_t filter)
+{
+    size_t typeSize = size_of_type(data.type);
+    size_t size = data.count * typeSize;
+    const uint8_t* values = data.data();
+
+    // Shuffle filters rearrange the bytes of the whole array as they are stored in the file
+
+    if (has_shuffle(filter))
+    {
+        std::vector<uint8_t> prepared((data.count + 2) * typeSize);
+        const uint8_t* ptr = prepare_values<reverse_bytes>(filter, values, prepared.data(), 0, data.count, typeSize);
+
+        buffer.resize(size);
+        apply_filter(filter, ptr, buffer.data(), data.count, typeSize);
+
+        return deflate_next(cs, buffer.data(), size);
+    }
+
+    if (!reverse_bytes && !has_transform(filter))
+    {
+        return deflate_next(cs, const_cast<uint8_t*>(values), size);
+    }
+
+    // Other values are prepared one chunk at a time, so large arrays are never copied whole
+
+    size_t chunkCount = std::max<size_t>(cValueChunkSize / std::max<size_t>(typeSize, 1), 1);
+    buffer.resize((chunkCount + 2) * typeSize);
+
+    for (size_t first = 0; first < data.count; first += chunkCount)
+    {
+        size_t count = std::min(chunkCount, data.count - first);
+        uint8_t* ptr = prepare_values<reverse_bytes>(filter, values, buffer.data(), first, count, typeSize);
+
+        if (deflate_next(cs, ptr, count * typeSize) != COMPRESS_SUCCESS)
+        {
+            return COMPRESS_ERROR;
+        }
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+// Deflate a block
+//    [?] header (see encode_block_header)
+//    [?] key
+//    [?] padding to cBlockAlignment (if flags has POD_FLAGS_ALIGN)
+//    [?] values
+//    [?] padding to cBlockAlignment (if flags has POD_FLAGS_ALIGN)
+// returns COMPRESS_SUCCESS on success
+// and COMPRESS_ERROR on failure
+template<bool reverse_bytes>
+compress_result deflate_block(compress_stream& cs, std::vector<uint8_t>& buffer, std::string_view key, const PodData& data, pod_flags_t flags)
+{
+    bool filtered = (flags & POD_FLAGS_FILTER) != 0;
+    bool aligned = (flags & POD_FLAGS_ALIGN) != 0;
+    uint32_t filter = filtered ? data.filter : POD_FILTER_NONE;
+
+    // Write header
+
+    size_t keyPos = block_header_size(flags);
+    size_t valuePos = keyPos + key.size();
+
+    if (aligned)
+    {
+        valuePos = next_multiple_of(valuePos, cBlockAlignment);
+    }
+
+    buffer.resize(valuePos);
+
+    encode_block_header<reverse_bytes>(buffer, static_cast<uint32_t>(key.size()), data.count, data.type, filter, flags);
+
+    set_bytes<uint8_t , reverse_bytes>(buffer, key.data(), keyPos, key.size());
+    pad_bytes(buffer, keyPos + key.size(), valuePos - keyPos - key.size());
+
+    if (deflate_next(cs, buffer.data(), buffer.size()) != COMPRESS_SUCCESS)
+    {
+        return COMPRESS_ERROR;
+    }
+
+    // Write data
+
+    if (deflate_block_values<reverse_bytes>(cs, buffer, data, filter) != COMPRESS_SUCCESS)
+    {
+        return COMPRESS_ERROR;
+    }
+
+    if (aligned)
+    {
+        size_t size = data.count * size_of_type(data.type);
+        size_t padding = next_multiple_of(size, cBlockAlignment) - size;
+
+        buffer.assign(padding, 0);
+
+        return deflate_next(cs, buffer.data(), padding);
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+// Inflate the header and key of a block
+// filter is set to POD_FILTER_NONE unless flags has POD_FLAGS_FILTER
+// returns COMPRESS_SUCCESS on success,
+// COMPRESS_STREAM_END if the stream ended before the block started,
+// and COMPRESS_ERROR on failure
+template<bool reverse_bytes>
+compress_result inflate_block_header(compress_stream& is, std::vector<uint8_t>& buffer, std::string& key, uint64_t& valueCount, pod_type_t& type, uint32_t& filter, pod_flags_t flags)
+{
+    // Inflate sizes
+
+    size_t headerSize = block_header_size(flags);
+
+    buffer.resize(headerSize);
+    compress_result r = inflate_next(is, buffer.data(), headerSize);
+
+    if ((r == COMPRESS_STREAM_END) && (is.zs.avail_out == headerSize))
+    {
+        return COMPRESS_STREAM_END;
+    }
+
+    // a partial header is corrupt
+    if ((r == COMPRESS_ERROR) || (is.zs.avail_out != 0))
+    {
+        return COMPRESS_ERROR;
+    }
+
+    // Set sizes
+
+    uint32_t strSize;
+
+    // the values can't be more than the rest of the stream inflates to
+
+    if (!decode_block_header<reverse_bytes>(buffer, strSize, valueCount, type, filter, flags) ||
+        (valueCount > is.max_out / size_of_type(type)))
+    {
+        return COMPRESS_ERROR;
+    }
+
+    // Inflate key
+
+    buffer.resize(strSize);
+    r = inflate_next(is, buffer.data(), buffer.size());
+
+    // the stream may end with the key of an empty block
+    if ((r == COMPRESS_ERROR) || (is.zs.avail_out != 0))
+    {
+        return COMPRESS_ERROR;
+    }
+
+    key.assign(reinterpret_cast<char*>(buffer.data()), strSize);
+
+    // Skip padding
+
+    if ((flags & POD_FLAGS_ALIGN) != 0)
+    {
+        size_t padding = next_multiple_of(headerSize + strSize, cBlockAlignment) - headerSize - strSize;
+
+        buffer.resize(padding);
+        r = inflate_next(is, buffer.data(), padding);
+
+        if ((r == COMPRESS_ERROR) || (is.zs.avail_out != 0))
+        {
+            return COMPRESS_ERROR;
+        }
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+// Inflate the values of a block into data
+// data.count, data.type, and data.filter must already be set
+// returns COMPRESS_SUCCESS or COMPRESS_STREAM_END on success
+// (COMPRESS_STREAM_END means that the block was the last in the stream)
+// and COMPRESS_ERROR on failure
+template<bool reverse_bytes>
+compress_result inflate_block_values(compress_stream& is, std::vector<uint8_t>& buffer, PodData& data, pod_flags_t flags)
+{
+    size_t typeSize = size_of_type(data.type);
+    size_t blockSize = data.count * typeSize;
+
+    uint8_t* values = data.values.allocate(blockSize);
+
+    compress_result r;
+
+    // Values are inflated in place unless a shuffle has to be undone,
+    // so only shuffled arrays need a second buffer
+
+    if (!has_shuffle(data.filter))
+    {
+        r = inflate_next(is, values, blockSize);
+    }
+    else
+    {
+        buffer.resize(blockSize);
+        r = inflate_next(is, buffer.data(), buffer.size());
+
+        remove_filter(data.filter, buffer.data(), values, data.count, typeSize);
+    }
+
+    if constexpr (reverse_bytes)
+    {
+        swap_values(values, values, data.count, typeSize);
+    }
+
+    // the stream must not end before the values are filled
+    if ((r == COMPRESS_STREAM_END) && (is.zs.avail_out != 0))
+    {
+        return COMPRESS_ERROR;
+    }
+
+    if (has_transform(data.filter))
+    {
+        remove_transform(data.filter, values, data.count, size_of_type(data.type));
+    }
+
+    // Skip padding
+
+    size_t padding = next_multiple_of(blockSize, cBlockAlignment) - blockSize;
+
+    if (((flags & POD_FLAGS_ALIGN) != 0) && (padding != 0))
+    {
+        // the stream can't end before the padding
+        if (r == COMPRESS_STREAM_END)
+        {
+            return COMPRESS_ERROR;
+        }
+
+        buffer.resize(padding);
+        r = inflate_next(is, buffer.data(), padding);
+
+        if ((r == COMPRESS_STREAM_END) && (is.zs.avail_out != 0))
+        {
+            return COMPRESS_ERROR;
+        }
+    }
+
+    return r;
+}
+
+// Returns true if the stored bytes of a block match its checksum
+// (only for files with POD_FLAGS_BLOCK_CHECKSUM)
+inline bool check_block(const PodHeader& header, const uint8_t* block, uint64_t size, uint32_t check32)
+{
+    return checksum_update(header.checksum, checksum_initial(header.checksum), block, size) == check32;
+}
+
+// Inflate a block that starts at offset on a flush boundary
+// end is the file offset where the body ends
+// if the file has POD_FLAGS_BLOCK_CHECKSUM, then size is the stored size of the block
+// and its bytes are checked against check32 before they are inflated
+// data.count, data.type, and data.filter must match the header of the block
+// the key of the block is returned in key
+// returns POD_SUCCESS on success
+// and POD_FILE_CORRUPT if the block is corrupt or doesn't match data
+template<bool reverse_bytes>
+pod_result_t read_block_at(File& file, const PodHeader& header, uint64_t offset, uint64_t end, uint64_t size, uint32_t check32, std::vector<uint8_t>& buffer, std::string& key, PodData& data)
+{
+    if ((offset > end) || !file.seek(offset))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    compress_stream is {};
+    std::vector<uint8_t> block;
+
+    if ((header.flags & POD_FLAGS_BLOCK_CHECKSUM) != 0)
+    {
+        if (size > end - offset)
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        block.resize(size);
+
+        if ((file.read(block.data(), block.size()) != block.size()) || !check_block(header, block.data(), size, check32))
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        if (inflate_init_buffer(is, block.data(), header.codec, size) != COMPRESS_SUCCESS)
+        {
+            return POD_ZLIB_ERROR;
+        }
+    }
+    else if (inflate_init(is, &file, header.codec, end - offset, POD_CHECKSUM_NONE, 0) != COMPRESS_SUCCESS)
+    {
+        return POD_ZLIB_ERROR;
+    }
+
+    uint64_t valueCount;
+    uint32_t filter;
+    pod_type_t type;
+
+    compress_result r = inflate_block_header<reverse_bytes>(is, buffer, key, valueCount, type, filter, header.flags);
+
+    if ((r != COMPRESS_SUCCESS) || (valueCount != data.count) || (type != data.type) || (filter != data.filter))
+    {
+        inflate_end(is);
+        return POD_FILE_CORRUPT;
+    }
+
+    r = inflate_block_values<reverse_bytes>(is, buffer, data, header.flags);
+
+    if ((inflate_end(is) != COMPRESS_SUCCESS) || (r == COMPRESS_ERROR))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    return POD_SUCCESS;
+}
+
+#endif
@@ -34,6 +34,29 @@ size_t size_of_type(pod_type_t type)
     return type & 0xffffu;
 }
 
+bool to_pod_type(uint32_t rawType, pod_type_t& type)
+{
+    switch (rawType)
+    {
+        case POD_ASCII_CHAR8:
+        case POD_UTF8_CHAR8:
+        case POD_UINT8:
+        case POD_UINT16:
+        case POD_UINT32:
+        case POD_UINT64:
+        case POD_INT8:
+        case POD_INT16:
+        case POD_INT32:
+        case POD_INT64:
+        case POD_FLOAT32:
+        case POD_FLOAT64:
+            type = static_cast<pod_type_t>(rawType);
+            return true;
+        default:
+            return false;
+    }
+}
+
 void pad_bytes(std::vector<uint8_t>& v, size_t firstByte, size_t numBytes)
 {
     // check that there is enough space
@@ -118,6 +118,10 @@ void get_bytes(void* dst, const std::vector<uint8_t>& src, size_t firstByte, siz
 
 size_t size_of_type(pod_type_t type);
 
+// Convert a raw type read from a file to a pod_type_t
+// returns false if rawType isn't a valid type
+bool to_pod_type(uint32_t rawType, pod_type_t& type);
+
 void pad_bytes(std::vector<uint8_t>& v, size_t firstByte, size_t numBytes);
 
 size_t next_multiple_of(size_t val, size_t multiple);
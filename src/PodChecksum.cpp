@@ -0,0 +1,429 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodChecksum.h"
+#include "PodThreadPool.h"
+#include "zlib.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <future>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define POD_X86_SIMD
+#include <immintrin.h>
+#endif
+
+// CRC32C (Castagnoli), reflected polynomial
+constexpr uint32_t cCrc32cPoly = 0x82F63B78u;
+
+// Slicing tables of CRC32C, table[k][n] is the CRC of byte n followed by k zero bytes
+using crc_tables = std::array<std::array<uint32_t, 256>, 8>;
+
+static constexpr crc_tables make_crc32c_tables()
+{
+    crc_tables tables = {};
+
+    for (uint32_t n = 0; n != 256; ++n)
+    {
+        uint32_t crc = n;
+
+        for (int bit = 0; bit != 8; ++bit)
+        {
+            crc = (crc & 1u) ? (crc >> 1) ^ cCrc32cPoly : (crc >> 1);
+        }
+
+        tables[0][n] = crc;
+    }
+
+    for (uint32_t n = 0; n != 256; ++n)
+    {
+        for (size_t k = 1; k != 8; ++k)
+        {
+            uint32_t crc = tables[k - 1][n];
+            tables[k][n] = (crc >> 8) ^ tables[0][crc & 0xFFu];
+        }
+    }
+
+    return tables;
+}
+
+static constexpr crc_tables cCrc32cTables = make_crc32c_tables();
+
+// Portable CRC32C of a pre-inverted crc, 8 bytes at a time
+static uint32_t crc32c_portable(uint32_t crc, const uint8_t* data, size_t size)
+{
+    const auto& t = cCrc32cTables;
+
+    while (size >= 8)
+    {
+        // the bytes are combined in little endian order on any host
+        uint32_t lo = crc ^ (
+            static_cast<uint32_t>(data[0]) |
+            (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) |
+            (static_cast<uint32_t>(data[3]) << 24));
+
+        crc =
+            t[7][lo & 0xFFu] ^
+            t[6][(lo >> 8) & 0xFFu] ^
+            t[5][(lo >> 16) & 0xFFu] ^
+            t[4][lo >> 24] ^
+            t[3][data[4]] ^
+            t[2][data[5]] ^
+            t[1][data[6]] ^
+            t[0][data[7]];
+
+        data += 8;
+        size -= 8;
+    }
+
+    while (size != 0)
+    {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFFu];
+        --size;
+    }
+
+    return crc;
+}
+
+#ifdef POD_X86_SIMD
+
+// CRC32C of a pre-inverted crc with the SSE4.2 crc32 instruction
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t* data, size_t size)
+{
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+
+    while (size >= 8)
+    {
+        uint64_t value;
+        memcpy(&value, data, 8);
+        crc64 = _mm_crc32_u64(crc64, value);
+
+        data += 8;
+        size -= 8;
+    }
+
+    crc = static_cast<uint32_t>(crc64);
+#endif
+
+    while (size >= 4)
+    {
+        uint32_t value;
+        memcpy(&value, data, 4);
+        crc = _mm_crc32_u32(crc, value);
+
+        data += 4;
+        size -= 4;
+    }
+
+    while (size != 0)
+    {
+        crc = _mm_crc32_u8(crc, *data++);
+        --size;
+    }
+
+    return crc;
+}
+
+// CRC32 of a pre-inverted crc, folding 64 bytes at a time with carry-less multiplication
+// size must be a multiple of 16, and at least 64
+// (Intel, "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction")
+__attribute__((target("sse4.1,pclmul")))
+static uint32_t crc32_pclmul(uint32_t crc, const uint8_t* data, size_t size)
+{
+    alignas(16) static const uint64_t k1k2[] = { 0x0154442BD4u, 0x01C6E41596u };
+    alignas(16) static const uint64_t k3k4[] = { 0x01751997D0u, 0x00CCAA009Eu };
+    alignas(16) static const uint64_t k5k0[] = { 0x0163CD6124u, 0x0000000000u };
+    alignas(16) static const uint64_t poly[] = { 0x01DB710641u, 0x01F7011641u };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+
+    data += 64;
+    size -= 64;
+
+    // Fold 4 blocks of 16 bytes in parallel
+
+    while (size >= 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+
+        data += 64;
+        size -= 64;
+    }
+
+    // Fold the 4 blocks into 1
+
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+    for (__m128i next : { x2, x3, x4 })
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+    }
+
+    // Fold the remaining blocks of 16 bytes
+
+    while (size >= 16)
+    {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        data += 16;
+        size -= 16;
+    }
+
+    // Fold 128 bits to 64 bits
+
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif
+
+// Functions picked for the CPU the first time a checksum is computed
+struct checksum_functions
+{
+    uint32_t (*crc32c)(uint32_t crc, const uint8_t* data, size_t size);
+    bool pclmul;
+};
+
+static const checksum_functions& get_checksum_functions()
+{
+    static const checksum_functions functions = []()
+    {
+        checksum_functions f = { crc32c_portable, false };
+
+#ifdef POD_X86_SIMD
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+            f.crc32c = crc32c_sse42;
+        }
+
+        f.pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+
+        return f;
+    }();
+
+    return functions;
+}
+
+// Multiply two polynomials modulo the reflected CRC32C polynomial
+// (zlib, "crc32.c", multmodp)
+static constexpr uint32_t crc32c_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+
+    while (true)
+    {
+        if ((a & m) != 0)
+        {
+            p ^= b;
+
+            if ((a & (m - 1)) == 0)
+            {
+                break;
+            }
+        }
+
+        m >>= 1;
+        b = (b & 1u) ? (b >> 1) ^ cCrc32cPoly : (b >> 1);
+    }
+
+    return p;
+}
+
+// x^(2^k) modulo the CRC32C polynomial, for k = 0...31
+using crc_powers = std::array<uint32_t, 32>;
+
+static constexpr crc_powers make_crc32c_powers()
+{
+    crc_powers powers = {};
+
+    uint32_t p = 1u << 30;  // x^1
+
+    for (auto& power : powers)
+    {
+        power = p;
+        p = crc32c_multmodp(p, p);
+    }
+
+    return powers;
+}
+
+static constexpr crc_powers cCrc32cPowers = make_crc32c_powers();
+
+// CRC32C of a first span followed by size2 bytes, given the CRC of each span
+static uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t size2)
+{
+    // shift crc1 over the bytes of the second span by multiplying it with x^(8 * size2)
+
+    uint32_t p = 1u << 31;  // x^0
+
+    for (size_t k = 3; size2 != 0; size2 >>= 1, ++k)
+    {
+        if ((size2 & 1u) != 0)
+        {
+            p = crc32c_multmodp(cCrc32cPowers[k & 31], p);
+        }
+    }
+
+    return crc32c_multmodp(p, crc1) ^ crc2;
+}
+
+// Shorter inputs aren't worth the setup of the carry-less multiplication path
+constexpr size_t cMinPclmulSize = 256;
+
+static uint32_t crc32_update(uint32_t check32, const uint8_t* data, size_t size)
+{
+#ifdef POD_X86_SIMD
+    if ((size >= cMinPclmulSize) && get_checksum_functions().pclmul)
+    {
+        size_t folded = size & ~static_cast<size_t>(15);
+
+        check32 = ~crc32_pclmul(~check32, data, folded);
+
+        data += folded;
+        size -= folded;
+    }
+#endif
+
+    return crc32_z(check32, data, size);
+}
+
+uint32_t checksum_initial(pod_checksum_t checksum)
+{
+    // adler32 sums start at 1, and crc32 and crc32c start at 0
+    return (checksum == POD_CHECKSUM_ADLER32) ? 1u : 0u;
+}
+
+uint32_t checksum_combine(pod_checksum_t checksum, uint32_t check1, uint32_t check2, uint64_t size2)
+{
+    if (checksum == POD_CHECKSUM_ADLER32)
+    {
+        return adler32_combine64(check1, check2, static_cast<z_off64_t>(size2));
+    }
+    else if (checksum == POD_CHECKSUM_CRC32)
+    {
+        return crc32_combine64(check1, check2, static_cast<z_off64_t>(size2));
+    }
+    else if (checksum == POD_CHECKSUM_CRC32C)
+    {
+        return crc32c_combine(check1, check2, size2);
+    }
+
+    return check1;
+}
+
+uint32_t checksum_update(pod_checksum_t checksum, uint32_t check32, const uint8_t* data, size_t size)
+{
+    if (checksum == POD_CHECKSUM_ADLER32)
+    {
+        return adler32_z(check32, data, size);
+    }
+    else if (checksum == POD_CHECKSUM_CRC32)
+    {
+        return crc32_update(check32, data, size);
+    }
+    else if (checksum == POD_CHECKSUM_CRC32C)
+    {
+        return ~get_checksum_functions().crc32c(~check32, data, size);
+    }
+
+    return check32;
+}
+
+uint32_t checksum_update_parallel(pod_checksum_t checksum, uint32_t check32, const uint8_t* data, size_t size, ThreadPool& pool)
+{
+    // spans smaller than this aren't worth a task
+    constexpr size_t cMinSpanSize = 1u << 20;
+
+    size_t spanCount = std::min(pool.size(), size / cMinSpanSize);
+
+    if ((checksum == POD_CHECKSUM_NONE) || (spanCount < 2))
+    {
+        return checksum_update(checksum, check32, data, size);
+    }
+
+    size_t spanSize = (size + spanCount - 1) / spanCount;
+
+    std::vector<uint32_t> checks(spanCount);
+    std::vector<std::future<void>> done;
+    done.reserve(spanCount);
+
+    for (size_t i = 0; i != spanCount; ++i)
+    {
+        size_t pos = i * spanSize;
+        size_t count = std::min(spanSize, size - pos);
+
+        done.push_back(pool.submit([checksum, data, pos, count, &checks, i]()
+        {
+            checks[i] = checksum_update(checksum, checksum_initial(checksum), data + pos, count);
+        }));
+    }
+
+    for (size_t i = 0; i != spanCount; ++i)
+    {
+        size_t pos = i * spanSize;
+
+        done[i].wait();
+        check32 = checksum_combine(checksum, check32, checks[i], std::min(spanSize, size - pos));
+    }
+
+    return check32;
+}
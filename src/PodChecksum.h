@@ -0,0 +1,31 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_CHECKSUM_H
+#define POD_CHECKSUM_H
+
+#include "pod_io.h"
+
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+
+// Update a running checksum with size bytes of data
+// returns check32 unchanged if checksum is POD_CHECKSUM_NONE
+uint32_t checksum_update(pod_checksum_t checksum, uint32_t check32, const uint8_t* data, size_t size);
+
+// Returns the checksum of zero bytes, which block checksums start from
+uint32_t checksum_initial(pod_checksum_t checksum);
+
+// Returns the checksum of two spans of bytes, given check1, the running checksum up to the end of the first span,
+// and check2, the checksum of the size2 bytes of the second span starting from checksum_initial()
+// The result is the same as updating check1 with the bytes of the second span,
+// so spans of a stream can be checksummed on different threads.
+uint32_t checksum_combine(pod_checksum_t checksum, uint32_t check1, uint32_t check2, uint64_t size2);
+
+// Update a running checksum with size bytes of data, split into spans that are checksummed by the threads of pool
+// small sizes are checksummed on the calling thread, the result is the same as checksum_update()
+uint32_t checksum_update_parallel(pod_checksum_t checksum, uint32_t check32, const uint8_t* data, size_t size, ThreadPool& pool);
+
+#endif
@@ -0,0 +1,56 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodCodec.h"
+
+#include <cstring>
+
+// Codecs in the order of compress_codec
+static const codec_interface* const codecs[] =
+    {
+        &deflate_codec,
+        &store_codec,
+        &lz_codec,
+    };
+
+const codec_interface& get_codec(compress_codec codec)
+{
+    return *codecs[codec];
+}
+
+bool find_codec(const uint8_t* tag, compress_codec& codec)
+{
+    for (size_t i = 0; i != sizeof(codecs) / sizeof(codecs[0]); ++i)
+    {
+        if (memcmp(codecs[i]->tag, tag, 4) == 0)
+        {
+            codec = static_cast<compress_codec>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool to_compress_codec(pod_codec_t codec, pod_compression_t compression, compress_codec& streamCodec)
+{
+    switch(codec)
+    {
+        case POD_CODEC_DEFLATE:
+            streamCodec = CODEC_DEFLATE;
+            break;
+        case POD_CODEC_LZ:
+            streamCodec = CODEC_LZ;
+            break;
+        default:
+            return false;
+    }
+
+    // Uncompressed values are stored directly so that they can be mapped
+    if (compression == POD_COMPRESSION_0)
+    {
+        streamCodec = CODEC_STORE;
+    }
+
+    return true;
+}
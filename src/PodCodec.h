@@ -0,0 +1,66 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_CODEC_H
+#define POD_CODEC_H
+
+#include "pod_io.h"
+#include "PodDeflate.h"
+
+#include <cstdint>
+
+// The functions that implement a codec for a compress_stream
+// The fields common to every codec (file, checksum, ...) are set before init is called.
+struct codec_interface
+{
+    const uint8_t* tag;        // 4 byte tag that names the codec in the reserved header field
+    uint32_t max_ratio;        // most bytes that one byte of the stream can inflate to
+
+    compress_result (*deflate_init)(compress_stream& cs, pod_compression_t compression);
+    compress_result (*deflate_next)(compress_stream& cs, uint8_t* in, size_t in_size);
+    compress_result (*deflate_flush)(compress_stream& cs);
+    compress_result (*deflate_end)(compress_stream& cs);
+
+    compress_result (*inflate_init)(compress_stream& cs);
+    compress_result (*inflate_next)(compress_stream& cs, uint8_t* out, size_t out_size);
+    compress_result (*inflate_end)(compress_stream& cs);
+};
+
+// Built-in codecs
+extern const codec_interface deflate_codec;
+extern const codec_interface store_codec;
+extern const codec_interface lz_codec;
+
+// Returns the interface of a codec
+const codec_interface& get_codec(compress_codec codec);
+
+// Find the codec named by a 4 byte tag
+// returns false if no codec has the tag
+bool find_codec(const uint8_t* tag, compress_codec& codec);
+
+// Find the codec used to save a file with a pod_codec_t and compression level
+// POD_COMPRESSION_0 stores the values without any codec framing
+// returns false if codec is invalid
+bool to_compress_codec(pod_codec_t codec, pod_compression_t compression, compress_codec& streamCodec);
+
+// Write bytes to the file of a deflate stream
+// and add them to the checksum and cs.total_out
+void stream_write(compress_stream& cs, const uint8_t* data, size_t size);
+
+// Write bytes that were already checksummed to the file of a deflate stream
+// check32 is the checksum of the bytes starting from checksum_initial(), which is combined into the checksum
+void stream_write_checked(compress_stream& cs, const uint8_t* data, size_t size, uint32_t check32);
+
+// Mark a flush point at cs.total_out, once every byte before it is written
+void stream_flush_point(compress_stream& cs);
+
+// Refill the input buffer (zs.next_in, zs.avail_in) of an inflate stream
+// from its source or file, once the buffer is empty
+// returns the number of bytes that are available
+size_t stream_fill(compress_stream& cs);
+
+// Read bytes from the input of an inflate stream and add them to the checksum
+// returns the number of bytes read, which is less than size at the end of the input
+size_t stream_read(compress_stream& cs, uint8_t* out, size_t size);
+
+#endif
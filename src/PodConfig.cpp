@@ -0,0 +1,60 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+#include "PodConfig.h"
+
+#include <atomic>
+#include <thread>
+
+static std::atomic<uint32_t> threadCount(1);
+static std::atomic<size_t> ioBufferSize(4u << 20);
+static std::atomic<bool> blockCache(false);
+
+// Largest chunk size, which fits in the 32-bit sizes of z_stream
+constexpr uint64_t cMaxIoBufferSize = 1u << 30;
+
+pod_result_t pod_set_thread_count(uint32_t count)
+{
+    threadCount = count;
+    return POD_SUCCESS;
+}
+
+size_t config_thread_count()
+{
+    size_t count = threadCount;
+
+    if (count == 0)
+    {
+        count = std::thread::hardware_concurrency();
+    }
+
+    return (count == 0) ? 1 : count;
+}
+
+pod_result_t pod_set_io_buffer_size(uint64_t size)
+{
+    if (size > cMaxIoBufferSize)
+    {
+        return POD_OUT_OF_RANGE;
+    }
+
+    ioBufferSize = static_cast<size_t>(size);
+    return POD_SUCCESS;
+}
+
+size_t config_io_buffer_size()
+{
+    return ioBufferSize;
+}
+
+pod_result_t pod_set_block_cache(uint32_t enabled)
+{
+    blockCache = (enabled != 0);
+    return POD_SUCCESS;
+}
+
+bool config_block_cache()
+{
+    return blockCache;
+}
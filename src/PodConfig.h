@@ -0,0 +1,19 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_CONFIG_H
+#define POD_CONFIG_H
+
+#include <cstddef>
+
+// Returns the number of threads used to save and load files (at least 1)
+size_t config_thread_count();
+
+// Returns the size of the chunks that files are read and written in on a background thread
+// or 0 if files are read and written on the calling thread
+size_t config_io_buffer_size();
+
+// Returns true if indexed saves keep the compressed block of every item
+bool config_block_cache();
+
+#endif
@@ -3,12 +3,195 @@
 
 #include "PodDeflate.h"
 #include "PodBytes.h"
+#include "PodChecksum.h"
+#include "PodCodec.h"
+#include "PodLookup.h"
+#include "PodConfig.h"
+#include "PodParallelDeflate.h"
+#include "PodPipeline.h"
 
-compress_result deflate_init(compress_stream& is, File* file, pod_compression_t compression, pod_checksum_t checksum, uint32_t check32)
+#include <algorithm>
+#include <limits>
+
+// Largest number of bytes passed to a codec at once, which fits in the 32-bit sizes of z_stream
+constexpr size_t cMaxPartSize = 1u << 30;
+
+// Write bytes to the file of a deflate stream without checksumming them
+static void stream_write_unchecked(compress_stream& cs, const uint8_t* data, size_t size)
+{
+    if (cs.writer != nullptr)
+    {
+        cs.writer->write(data, size);
+    }
+    else
+    {
+        cs.file->write(data, size);
+    }
+
+    cs.total_out += size;
+
+    if (cs.capture != nullptr)
+    {
+        cs.capture->insert(cs.capture->end(), data, data + size);
+    }
+}
+
+void stream_write(compress_stream& cs, const uint8_t* data, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    stream_write_unchecked(cs, data, size);
+
+    // the thread that writes the file checksums the bytes instead, if there is one
+
+    if ((cs.writer != nullptr) && cs.writer->checksummed())
+    {
+        return;
+    }
+
+    cs.check32 = checksum_update(cs.checksum, cs.check32, data, size);
+
+    if (cs.block_checks)
+    {
+        cs.block_check32 = checksum_update(cs.checksum, cs.block_check32, data, size);
+    }
+}
+
+void stream_write_checked(compress_stream& cs, const uint8_t* data, size_t size, uint32_t check32)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    stream_write_unchecked(cs, data, size);
+
+    cs.check32 = checksum_combine(cs.checksum, cs.check32, check32, size);
+
+    if (cs.block_checks)
+    {
+        cs.block_check32 = checksum_combine(cs.checksum, cs.block_check32, check32, size);
+    }
+}
+
+void stream_flush_point(compress_stream& cs)
+{
+    cs.flushes.push_back(cs.total_out);
+
+    if (!cs.block_checks)
+    {
+        return;
+    }
+
+    if ((cs.writer != nullptr) && cs.writer->checksummed())
+    {
+        cs.writer->mark();
+    }
+    else
+    {
+        cs.flush_checks.push_back(cs.block_check32);
+        cs.block_check32 = checksum_initial(cs.checksum);
+    }
+}
+
+// Add bytes consumed by an inflate stream to its checksum
+// bytes that are read ahead are checksummed by the thread that reads them instead (see inflate_end)
+static void stream_check(compress_stream& cs, const uint8_t* data, size_t size)
+{
+    if (cs.reader == nullptr)
+    {
+        cs.check32 = checksum_update(cs.checksum, cs.check32, data, size);
+    }
+}
+
+size_t stream_fill(compress_stream& cs)
+{
+    auto& zs = cs.zs;
+
+    if (zs.avail_in != 0)
+    {
+        return zs.avail_in;
+    }
+
+    if (cs.source != nullptr)
+    {
+        // avail_in is only 32 bits
+        size_t size = std::min<uint64_t>(cs.remaining, std::numeric_limits<uInt>::max());
+
+        zs.next_in = const_cast<uint8_t*>(cs.source);
+        zs.avail_in = size;
+
+        cs.source += size;
+        cs.remaining -= size;
+    }
+    else if (cs.reader != nullptr)
+    {
+        size_t size;
+
+        zs.next_in = const_cast<uint8_t*>(cs.reader->next(size));
+        zs.avail_in = size;
+
+        cs.remaining -= std::min<uint64_t>(cs.remaining, size);
+    }
+    else
+    {
+        // files in memory are inflated in place
+        size_t size;
+        const uint8_t* view = cs.file->read_view(std::numeric_limits<uInt>::max(), size);
+
+        if (view != nullptr)
+        {
+            zs.next_in = const_cast<uint8_t*>(view);
+            zs.avail_in = size;
+        }
+        else
+        {
+            zs.avail_in = cs.file->read(cs.buffer, sizeof(cs.buffer));
+            zs.next_in = cs.buffer;
+        }
+    }
+
+    return zs.avail_in;
+}
+
+size_t stream_read(compress_stream& cs, uint8_t* out, size_t size)
+{
+    auto& zs = cs.zs;
+
+    size_t done = 0;
+
+    while ((done != size) && (stream_fill(cs) != 0))
+    {
+        size_t ds = std::min<size_t>(zs.avail_in, size - done);
+
+        memcpy(out + done, zs.next_in, ds);
+        stream_check(cs, zs.next_in, ds);
+
+        zs.next_in += ds;
+        zs.avail_in -= ds;
+        done += ds;
+    }
+
+    return done;
+}
+
+// Write the bytes held in the output buffer and reset it
+static void write_buffer(compress_stream& is)
 {
     auto& zs = is.zs;
 
-    zs =
+    stream_write(is, is.buffer, sizeof(is.buffer) - zs.avail_out);
+
+    zs.avail_out = sizeof(is.buffer);
+    zs.next_out = is.buffer;
+}
+
+compress_result deflate_init(compress_stream& is, File* file, compress_codec codec, pod_compression_t compression, pod_checksum_t checksum, uint32_t check32)
+{
+    is.zs =
         {
             .zalloc = Z_NULL,
             .zfree = Z_NULL,
@@ -16,8 +199,214 @@ compress_result deflate_init(compress_stream& is, File* file, pod_compression_t
         };
 
     is.file = file;
+    is.source = nullptr;
+    is.codec = codec;
+    is.remaining = 0;
     is.checksum = checksum;
     is.check32 = check32;
+    is.total_out = 0;
+    is.flushes.clear();
+    is.flush_checks.clear();
+    is.block_checks = false;
+    is.block_check32 = checksum_initial(checksum);
+    is.parallel.reset();
+    is.capture = nullptr;
+    is.writer.reset();
+
+    compress_result r = get_codec(codec).deflate_init(is, compression);
+
+    // The writer thread also checksums the bytes it writes, off the thread that deflates them
+    // parallel streams are checksummed by their workers instead (see stream_write_checked)
+
+    size_t bufferSize = config_io_buffer_size();
+
+    if ((file != nullptr) && file->is_named() && (bufferSize != 0))
+    {
+        pod_checksum_t writerChecksum = (is.parallel == nullptr) ? checksum : POD_CHECKSUM_NONE;
+
+        is.writer = std::make_shared<WriteBehind>(*file, bufferSize, writerChecksum, check32);
+    }
+
+    return r;
+}
+
+compress_result deflate_end(compress_stream& cs)
+{
+    compress_result r = get_codec(cs.codec).deflate_end(cs);
+
+    // the file is written in order once the stream ends
+
+    if (cs.writer != nullptr)
+    {
+        cs.writer->finish();
+
+        if (cs.writer->checksummed())
+        {
+            cs.check32 = cs.writer->check32();
+
+            const auto& checks = cs.writer->mark_checks();
+            cs.flush_checks.insert(cs.flush_checks.end(), checks.begin(), checks.end());
+        }
+
+        cs.writer.reset();
+    }
+
+    return r;
+}
+
+compress_result deflate_next(compress_stream& cs, uint8_t* in, size_t in_size)
+{
+    return get_codec(cs.codec).deflate_next(cs, in, in_size);
+}
+
+compress_result deflate_flush(compress_stream& cs)
+{
+    return get_codec(cs.codec).deflate_flush(cs);
+}
+
+compress_result deflate_copy_block(compress_stream& cs, const uint8_t* block, size_t size)
+{
+    // a flush point leaves nothing buffered by the codec
+    // and no dictionary, so the block can be written as is
+
+    if (cs.parallel != nullptr)
+    {
+        return parallel_deflate_copy_block(cs, block, size);
+    }
+
+    stream_write(cs, block, size);
+    stream_flush_point(cs);
+
+    return COMPRESS_SUCCESS;
+}
+
+compress_result inflate_init(compress_stream& is, File* file, compress_codec codec, uint64_t size, pod_checksum_t checksum, uint32_t check32)
+{
+    is.zs =
+        {
+            .next_in = Z_NULL,
+            .avail_in = 0,
+            .zalloc = Z_NULL,
+            .zfree = Z_NULL,
+            .opaque = Z_NULL,
+        };
+
+    is.file = file;
+    is.source = nullptr;
+    is.codec = codec;
+    is.remaining = size;
+    is.finished = false;
+    is.checksum = checksum;
+    is.check32 = check32;
+    is.reader.reset();
+
+    // A corrupt stream can't claim more bytes than its input can inflate to
+    // the input is unbounded if it ends at the end of a file that can't seek
+
+    constexpr uint64_t unbounded = std::numeric_limits<uint64_t>::max();
+
+    uint64_t inSize = unbounded;
+
+    if (size != 0)
+    {
+        inSize = size;
+    }
+    else if ((file != nullptr) && file->can_seek())
+    {
+        uint64_t offset = file->tell();
+        uint64_t fileSize = file->size();
+        inSize = fileSize - std::min(offset, fileSize);
+    }
+
+    uint64_t maxRatio = get_codec(codec).max_ratio;
+
+    is.max_out = (inSize <= unbounded / maxRatio) ? inSize * maxRatio : unbounded;
+
+    // Read ahead when there is more than one chunk to read
+    // the stream ends at size bytes when it is known, otherwise at the end of the file
+
+    size_t bufferSize = config_io_buffer_size();
+
+    if ((file != nullptr) && file->is_named() && (bufferSize != 0))
+    {
+        uint64_t offset = file->tell();
+        uint64_t fileSize = file->size();
+        uint64_t readSize = (size != 0) ? size : fileSize - std::min(offset, fileSize);
+
+        if (readSize > bufferSize)
+        {
+            is.reader = std::make_shared<ReadAhead>(*file, readSize, bufferSize, checksum);
+        }
+    }
+
+    return get_codec(codec).inflate_init(is);
+}
+
+compress_result inflate_init_buffer(compress_stream& is, const uint8_t* in, compress_codec codec, uint64_t size)
+{
+    compress_result r = inflate_init(is, nullptr, codec, size, POD_CHECKSUM_NONE, 0);
+
+    is.source = in;
+
+    return r;
+}
+
+compress_result inflate_end(compress_stream& cs)
+{
+    // the file continues after the bytes that the stream has read (see inflate_read_back)
+    // and the bytes that were read ahead without being used aren't part of the checksum
+
+    if (cs.reader != nullptr)
+    {
+        cs.check32 = cs.reader->checksum(cs.check32, cs.zs.avail_in);
+        cs.reader->stop();
+    }
+
+    return get_codec(cs.codec).inflate_end(cs);
+}
+
+compress_result inflate_next(compress_stream& cs, uint8_t* out, size_t out_size)
+{
+    const auto& codec = get_codec(cs.codec);
+
+    // avail_out is only 32 bits, so large outputs are inflated in parts
+
+    while (out_size > cMaxPartSize)
+    {
+        compress_result r = codec.inflate_next(cs, out, cMaxPartSize);
+
+        if (r != COMPRESS_SUCCESS)
+        {
+            // avail_out must count the parts that weren't filled
+            cs.zs.avail_out = std::numeric_limits<uInt>::max();
+            return r;
+        }
+
+        out += cMaxPartSize;
+        out_size -= cMaxPartSize;
+    }
+
+    return codec.inflate_next(cs, out, out_size);
+}
+
+void* inflate_read_back(compress_stream& cs, size_t& size)
+{
+    size = cs.zs.avail_in;
+    return cs.zs.next_in;
+}
+
+// DEFLATE (zlib)
+
+static compress_result zlib_deflate_init(compress_stream& is, pod_compression_t compression)
+{
+    auto& zs = is.zs;
+
+    size_t threadCount = config_thread_count();
+
+    if (threadCount > 1)
+    {
+        return parallel_deflate_init(is, compression, threadCount);
+    }
 
     if (deflateInit2(&zs, static_cast<int>(compression), Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
     {
@@ -30,28 +419,21 @@ compress_result deflate_init(compress_stream& is, File* file, pod_compression_t
     return COMPRESS_SUCCESS;
 }
 
-compress_result deflate_end(compress_stream& is)
+static compress_result zlib_deflate_end(compress_stream& is)
 {
     auto& zs = is.zs;
 
+    if (is.parallel != nullptr)
+    {
+        return parallel_deflate_end(is);
+    }
+
     int res = Z_OK;
     while (res == Z_OK)
     {
         if (zs.avail_out == 0)
         {
-            is.file->write(is.buffer, sizeof(is.buffer));
-
-            zs.avail_out = sizeof(is.buffer);
-            zs.next_out = is.buffer;
-
-            if (is.checksum == POD_CHECKSUM_ADLER32)
-            {
-                is.check32 = adler32(is.check32, is.buffer, sizeof(is.buffer));
-            }
-            else if (is.checksum == POD_CHECKSUM_CRC32)
-            {
-                is.check32 = crc32(is.check32, is.buffer, sizeof(is.buffer));
-            }
+            write_buffer(is);
         }
 
         res = deflate(&zs, Z_FINISH);
@@ -67,17 +449,7 @@ compress_result deflate_end(compress_stream& is)
     size_t ds = sizeof(is.buffer) - zs.avail_out;
     if (ds != 0)
     {
-        size_t size = sizeof(is.buffer) - zs.avail_out;
-        is.file->write(is.buffer, size);
-
-        if (is.checksum == POD_CHECKSUM_ADLER32)
-        {
-            is.check32 = adler32(is.check32, is.buffer, size);
-        }
-        else if (is.checksum == POD_CHECKSUM_CRC32)
-        {
-            is.check32 = crc32(is.check32, is.buffer, size);
-        }
+        write_buffer(is);
     }
 
     if (deflateEnd(&zs) != Z_OK)
@@ -88,59 +460,83 @@ compress_result deflate_end(compress_stream& is)
     return COMPRESS_SUCCESS;
 }
 
-compress_result deflate_next(compress_stream& is, uint8_t* in, size_t in_size)
+static compress_result zlib_deflate_flush(compress_stream& is)
 {
     auto& zs = is.zs;
 
-    zs.avail_in = in_size;
-    zs.next_in = in;
-
-    // Process all input, writing to file as necessary
-    while (zs.avail_in != 0)
+    if (is.parallel != nullptr)
     {
-        assert(zs.next_in != nullptr);
+        return parallel_deflate_flush(is);
+    }
+
+    zs.avail_in = 0;
 
-        if (deflate(&zs, Z_NO_FLUSH) != Z_OK)
+    while (true)
+    {
+        if (deflate(&zs, Z_FULL_FLUSH) != Z_OK)
         {
             return COMPRESS_ERROR;
         }
 
-        if (zs.avail_out == 0)
+        // deflate() must be called again if it filled the output buffer
+        bool done = (zs.avail_out != 0);
+
+        write_buffer(is);
+
+        if (done)
         {
-            is.file->write(is.buffer, sizeof(is.buffer));
+            break;
+        }
+    }
+
+    stream_flush_point(is);
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result zlib_deflate_next(compress_stream& is, uint8_t* in, size_t in_size)
+{
+    auto& zs = is.zs;
+
+    if (is.parallel != nullptr)
+    {
+        return parallel_deflate_next(is, in, in_size);
+    }
 
-            zs.avail_out = sizeof(is.buffer);
-            zs.next_out = is.buffer;
+    // avail_in is only 32 bits, so large inputs are deflated in parts
 
-            if (is.checksum == POD_CHECKSUM_ADLER32)
+    while (in_size != 0)
+    {
+        size_t size = std::min(in_size, cMaxPartSize);
+
+        zs.avail_in = size;
+        zs.next_in = in;
+
+        // Process all input, writing to file as necessary
+        while (zs.avail_in != 0)
+        {
+            assert(zs.next_in != nullptr);
+
+            if (deflate(&zs, Z_NO_FLUSH) != Z_OK)
             {
-                is.check32 = adler32(is.check32, is.buffer, sizeof(is.buffer));
+                return COMPRESS_ERROR;
             }
-            else if (is.checksum == POD_CHECKSUM_CRC32)
+
+            if (zs.avail_out == 0)
             {
-                is.check32 = crc32(is.check32, is.buffer, sizeof(is.buffer));
+                write_buffer(is);
             }
         }
+
+        in += size;
+        in_size -= size;
     }
 
     return COMPRESS_SUCCESS;
 }
 
-compress_result inflate_init(compress_stream& is, File* file, pod_checksum_t checksum, uint32_t check32)
+static compress_result zlib_inflate_init(compress_stream& is)
 {
-    is.zs =
-        {
-            .next_in = Z_NULL,
-            .avail_in = 0,
-            .zalloc = Z_NULL,
-            .zfree = Z_NULL,
-            .opaque = Z_NULL,
-        };
-
-    is.file = file;
-    is.checksum = checksum;
-    is.check32 = check32;
-
     if (inflateInit2(&is.zs, -15) != Z_OK)
     {
         return COMPRESS_ERROR;
@@ -149,7 +545,7 @@ compress_result inflate_init(compress_stream& is, File* file, pod_checksum_t che
     return COMPRESS_SUCCESS;
 }
 
-compress_result inflate_end(compress_stream& cs)
+static compress_result zlib_inflate_end(compress_stream& cs)
 {
     if (inflateEnd(&cs.zs) != Z_OK)
     {
@@ -159,7 +555,7 @@ compress_result inflate_end(compress_stream& cs)
     return COMPRESS_SUCCESS;
 }
 
-compress_result inflate_next(compress_stream& is, uint8_t* out, size_t out_size)
+static compress_result zlib_inflate_next(compress_stream& is, uint8_t* out, size_t out_size)
 {
     int r;
     auto& zs = is.zs;
@@ -167,13 +563,14 @@ compress_result inflate_next(compress_stream& is, uint8_t* out, size_t out_size)
     zs.avail_out = out_size;
     zs.next_out = out;
 
+    if (is.finished)
+    {
+        return COMPRESS_STREAM_END;
+    }
+
     while (zs.avail_out != 0)
     {
-        if (zs.avail_in == 0)
-        {
-            zs.avail_in = is.file->read(is.buffer, sizeof(is.buffer));
-            zs.next_in = is.buffer;
-        }
+        stream_fill(is);
 
         auto prev_next_in = zs.next_in;
         auto prev_avail_in = zs.avail_in;
@@ -186,17 +583,11 @@ compress_result inflate_next(compress_stream& is, uint8_t* out, size_t out_size)
             return COMPRESS_ERROR;
         }
 
-        if (is.checksum == POD_CHECKSUM_ADLER32)
-        {
-            is.check32 = adler32(is.check32, prev_next_in, prev_avail_in - zs.avail_in);
-        }
-        else if (is.checksum == POD_CHECKSUM_CRC32)
-        {
-            is.check32 = crc32(is.check32, prev_next_in, prev_avail_in - zs.avail_in);
-        }
+        stream_check(is, prev_next_in, prev_avail_in - zs.avail_in);
 
         if (r == Z_STREAM_END)
         {
+            is.finished = true;
             return COMPRESS_STREAM_END;
         }
 
@@ -209,8 +600,156 @@ compress_result inflate_next(compress_stream& is, uint8_t* out, size_t out_size)
     return COMPRESS_SUCCESS;
 }
 
-void* inflate_read_back(compress_stream& cs, size_t& size)
+const codec_interface deflate_codec =
+    {
+        .tag = cDEFL,
+        .max_ratio = 1032,
+        .deflate_init = zlib_deflate_init,
+        .deflate_next = zlib_deflate_next,
+        .deflate_flush = zlib_deflate_flush,
+        .deflate_end = zlib_deflate_end,
+        .inflate_init = zlib_inflate_init,
+        .inflate_next = zlib_inflate_next,
+        .inflate_end = zlib_inflate_end,
+    };
+
+// Stored bytes without any framing
+
+static compress_result store_deflate_init(compress_stream& is, pod_compression_t)
 {
-    size = cs.zs.avail_in;
-    return cs.zs.next_in;
+    is.zs.avail_out = sizeof(is.buffer);
+    is.zs.next_out = is.buffer;
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result store_deflate_end(compress_stream& is)
+{
+    write_buffer(is);
+
+    return COMPRESS_SUCCESS;
 }
+
+static compress_result store_deflate_flush(compress_stream& is)
+{
+    write_buffer(is);
+    stream_flush_point(is);
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result store_deflate_next(compress_stream& is, uint8_t* in, size_t in_size)
+{
+    auto& zs = is.zs;
+
+    while (in_size != 0)
+    {
+        size_t size = std::min<size_t>(in_size, zs.avail_out);
+
+        memcpy(zs.next_out, in, size);
+        zs.next_out += size;
+        zs.avail_out -= size;
+        in += size;
+        in_size -= size;
+
+        if (zs.avail_out == 0)
+        {
+            write_buffer(is);
+        }
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result store_inflate_init(compress_stream&)
+{
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result store_inflate_end(compress_stream&)
+{
+    return COMPRESS_SUCCESS;
+}
+
+// Copy stored bytes until the output buffer is filled
+static compress_result store_inflate_next(compress_stream& is, uint8_t* out, size_t out_size)
+{
+    auto& zs = is.zs;
+
+    zs.avail_out = out_size;
+    zs.next_out = out;
+
+    while (zs.avail_out != 0)
+    {
+        if (zs.avail_in == 0)
+        {
+            if (is.remaining == 0)
+            {
+                return COMPRESS_STREAM_END;
+            }
+
+            if ((is.source != nullptr) || (is.reader != nullptr))
+            {
+                if (stream_fill(is) == 0)
+                {
+                    return COMPRESS_ERROR;
+                }
+
+                continue;
+            }
+
+            // Large reads skip the temporary buffer
+            if (zs.avail_out >= sizeof(is.buffer))
+            {
+                size_t size = std::min<uint64_t>(zs.avail_out, is.remaining);
+
+                if (is.file->read(zs.next_out, size) != size)
+                {
+                    return COMPRESS_ERROR;
+                }
+
+                is.check32 = checksum_update(is.checksum, is.check32, zs.next_out, size);
+                is.remaining -= size;
+                zs.next_out += size;
+                zs.avail_out -= size;
+                continue;
+            }
+
+            size_t size = std::min<uint64_t>(sizeof(is.buffer), is.remaining);
+
+            if (is.file->read(is.buffer, size) != size)
+            {
+                return COMPRESS_ERROR;
+            }
+
+            is.remaining -= size;
+            zs.avail_in = size;
+            zs.next_in = is.buffer;
+        }
+
+        size_t size = std::min(zs.avail_in, zs.avail_out);
+
+        memcpy(zs.next_out, zs.next_in, size);
+        stream_check(is, zs.next_in, size);
+
+        zs.next_in += size;
+        zs.avail_in -= size;
+        zs.next_out += size;
+        zs.avail_out -= size;
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+const codec_interface store_codec =
+    {
+        .tag = cSTOR,
+        .max_ratio = 1,
+        .deflate_init = store_deflate_init,
+        .deflate_next = store_deflate_next,
+        .deflate_flush = store_deflate_flush,
+        .deflate_end = store_deflate_end,
+        .inflate_init = store_inflate_init,
+        .inflate_next = store_inflate_next,
+        .inflate_end = store_inflate_end,
+    };
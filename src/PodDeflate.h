@@ -13,14 +13,43 @@
 #include <fstream>
 #include <cstdio>
 #include <functional>
+#include <memory>
+
+struct parallel_deflate;
+class ReadAhead;
+class WriteBehind;
+
+enum compress_codec
+{
+    CODEC_DEFLATE,             // raw DEFLATE stream
+    CODEC_STORE,               // bytes are stored without any framing
+    CODEC_LZ,                  // built-in LZ77 frames (see PodLz.h)
+};
 
 struct compress_stream
 {
-    z_stream zs;               // zlib stream handle
+    z_stream zs;               // zlib stream handle (CODEC_STORE only uses the buffer fields)
     uint8_t buffer[8 * 1024];  // temporary buffer used for reading and writing file data
     File* file;                // pointer to file
+    const uint8_t* source;     // bytes to inflate instead of the file, or null (inflate only)
+    compress_codec codec;      // codec
+    uint64_t remaining;        // number of stored bytes left to read (CODEC_STORE or source only)
+    uint64_t max_out;          // most bytes that the stream can inflate to (inflate only)
+    bool finished;             // true once the end of the stream has been inflated
     pod_checksum_t checksum;       // checksum type
     uint32_t check32;          // 32-bit checksum
+    uint64_t total_out;        // number of bytes written to the file (deflate only)
+    std::vector<uint64_t> flushes;  // value of total_out at every flush point (deflate only)
+    std::vector<uint32_t> flush_checks;  // checksum of the bytes before every flush point, since the last one (block_checks only)
+    bool block_checks;         // true if flush_checks are kept (deflate only)
+    uint32_t block_check32;    // checksum of the bytes since the last flush point (block_checks only)
+    std::shared_ptr<parallel_deflate> parallel;  // worker threads, or null to deflate on the calling thread
+    std::shared_ptr<ReadAhead> reader;   // thread that reads the file ahead of the stream, or null (inflate only)
+    std::shared_ptr<WriteBehind> writer; // thread that writes the file behind the stream, or null (deflate only)
+    std::vector<uint8_t>* capture;  // copy of every byte written to the file, or null (deflate only)
+    std::vector<uint8_t> frame;     // uncompressed bytes of the current frame (CODEC_LZ only)
+    std::vector<uint8_t> packed;    // compressed bytes of the current frame (CODEC_LZ only)
+    size_t frame_pos;               // number of inflated frame bytes already returned (CODEC_LZ only)
 };
 
 enum compress_result
@@ -33,7 +62,7 @@ enum compress_result
 // Initialize a deflate stream
 // returns COMPRESS_SUCCESS on success
 // and COMPRESS_ERROR on failure
-compress_result deflate_init(compress_stream& cs, File* file, pod_compression_t compression, pod_checksum_t checksum, uint32_t check32);
+compress_result deflate_init(compress_stream& cs, File* file, compress_codec codec, pod_compression_t compression, pod_checksum_t checksum, uint32_t check32);
 
 // Finish deflating and write any extra bytes held by the stream
 // returns COMPRESS_SUCCESS on success
@@ -45,15 +74,36 @@ compress_result deflate_end(compress_stream& cs);
 // and COMPRESS_ERROR on failure
 compress_result deflate_next(compress_stream& cs, uint8_t* in, size_t in_size);
 
+// Mark a flush point and reset the compression dictionary
+// so that the next deflated byte starts a block that can be inflated on its own
+// the output offset of the flush point is appended to cs.flushes once it is known
+// returns COMPRESS_SUCCESS on success
+// and COMPRESS_ERROR on failure
+compress_result deflate_flush(compress_stream& cs);
+
+// Write a block that was deflated by an earlier stream with the same codec and level
+// must only be called at a flush point, and marks a flush point after the block
+// returns COMPRESS_SUCCESS on success
+// and COMPRESS_ERROR on failure
+compress_result deflate_copy_block(compress_stream& cs, const uint8_t* block, size_t size);
+
 // Initialize an inflate stream
+// size is the number of stored bytes in the file (CODEC_STORE only)
+// returns COMPRESS_SUCCESS on success
+// and COMPRESS_ERROR on failure
+compress_result inflate_init(compress_stream& cs, File* file, compress_codec codec, uint64_t size, pod_checksum_t checksum, uint32_t check32);
+
+// Initialize an inflate stream that reads size bytes from memory
+// in must stay valid until the stream is finished
 // returns COMPRESS_SUCCESS on success
 // and COMPRESS_ERROR on failure
-compress_result inflate_init(compress_stream& cs, File* file, pod_checksum_t checksum, uint32_t check32);
+compress_result inflate_init_buffer(compress_stream& cs, const uint8_t* in, compress_codec codec, uint64_t size);
 
 // Finish an inflate stream
 // returns COMPRESS_SUCCESS on success
 // and COMPRESS_ERROR on failure
 // extra bytes may have been read from the file (see inflate_read_back)
+// and they stay valid until the stream is initialized again or destroyed
 compress_result inflate_end(compress_stream& cs);
 
 // Inflate until the output buffer is filled
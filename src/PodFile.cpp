@@ -3,11 +3,31 @@
 
 #include "PodFile.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define pod_fseek _fseeki64
+#define pod_ftell _ftelli64
+#else
+#include <fcntl.h>
+#define pod_fseek fseeko
+#define pod_ftell ftello
+#endif
 
 File::File(const char* filename, FileMode mode)
     : m_file(nullptr)
     , m_mode(mode)
+    , m_backend(FB_STDIO)
+    , m_stream()
+    , m_failed(false)
+    , m_growable(false)
+    , m_data(nullptr)
+    , m_capacity(0)
+    , m_size(0)
+    , m_pos(0)
 {
     switch(m_mode)
     {
@@ -17,34 +37,304 @@ File::File(const char* filename, FileMode mode)
     case FM_WRITE:
         m_file = fopen(filename, "wb");
         break;
+    case FM_UPDATE:
+        m_file = fopen(filename, "r+b");
+        break;
     default:
         break;
     }
 }
 
+File::File(const uint8_t* data, uint64_t size)
+    : m_file(nullptr)
+    , m_mode(FM_READ)
+    , m_backend(FB_MEMORY)
+    , m_stream()
+    , m_failed(false)
+    , m_growable(false)
+    , m_data(const_cast<uint8_t*>(data))
+    , m_capacity(size)
+    , m_size(size)
+    , m_pos(0)
+{}
+
+File::File(uint8_t* data, uint64_t capacity, bool growable)
+    : m_file(nullptr)
+    , m_mode(FM_WRITE)
+    , m_backend(FB_MEMORY)
+    , m_stream()
+    , m_failed(false)
+    , m_growable(growable)
+    , m_data(data)
+    , m_capacity(capacity)
+    , m_size(0)
+    , m_pos(0)
+{}
+
+File::File(const pod_stream_t& stream, FileMode mode)
+    : m_file(nullptr)
+    , m_mode(mode)
+    , m_backend(FB_STREAM)
+    , m_stream(stream)
+    , m_failed(false)
+    , m_growable(false)
+    , m_data(nullptr)
+    , m_capacity(0)
+    , m_size(0)
+    , m_pos(0)
+{}
+
 File::~File()
 {
     if (m_file != nullptr)
     {
         fclose(m_file);
     }
+
+    if (m_growable)
+    {
+        free(m_data);
+    }
 }
 
 bool File::is_open() const
 {
-    return (m_file != nullptr);
+    switch (m_backend)
+    {
+    case FB_STDIO:
+        return m_file != nullptr;
+    case FB_STREAM:
+        return (m_mode == FM_READ) ? (m_stream.read != nullptr) : (m_stream.write != nullptr);
+    default:
+        return true;
+    }
+}
+
+bool File::can_seek() const
+{
+    return (m_backend != FB_STREAM) || ((m_stream.seek != nullptr) && (m_stream.size != nullptr));
+}
+
+bool File::flush()
+{
+    // buffered bytes that don't fit on the disk are only found to fail here
+    if ((m_backend == FB_STDIO) && (m_file != nullptr) && (m_mode != FM_READ) && (fflush(m_file) != 0))
+    {
+        m_failed = true;
+    }
+
+    return !m_failed;
+}
+
+bool File::failed() const
+{
+    return m_failed;
+}
+
+bool File::is_named() const
+{
+    return m_backend == FB_STDIO;
+}
+
+void File::advise_sequential()
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+    if ((m_backend == FB_STDIO) && (m_file != nullptr))
+    {
+        posix_fadvise(fileno(m_file), static_cast<off_t>(tell()), 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+}
+
+uint8_t* File::release()
+{
+    assert(m_growable);
+
+    uint8_t* data = m_data;
+
+    m_data = nullptr;
+    m_capacity = 0;
+
+    return data;
 }
 
 size_t File::write(const void* data, size_t size)
 {
-    assert(m_file != nullptr);
-    assert(m_mode == FM_WRITE);
-    return fwrite(data, 1u, size, m_file);
+    assert(m_mode != FM_READ);
+
+    size_t count;
+
+    switch (m_backend)
+    {
+    case FB_STDIO:
+        assert(m_file != nullptr);
+        count = fwrite(data, 1u, size, m_file);
+        break;
+    case FB_STREAM:
+        count = static_cast<size_t>(m_stream.write(m_stream.user, data, size));
+        m_pos += count;
+        m_size = std::max(m_size, m_pos);
+        break;
+    default:
+        count = write_memory(data, size);
+        break;
+    }
+
+    if (count != size)
+    {
+        m_failed = true;
+    }
+
+    return count;
+}
+
+size_t File::write_memory(const void* data, size_t size)
+{
+    if (m_growable && (m_pos + size > m_capacity))
+    {
+        uint64_t capacity = std::max<uint64_t>(m_pos + size, 2 * m_capacity);
+        auto grown = static_cast<uint8_t*>(realloc(m_data, capacity));
+
+        if (grown == nullptr)
+        {
+            return 0;
+        }
+
+        m_data = grown;
+        m_capacity = capacity;
+    }
+
+    if (m_pos < m_capacity)
+    {
+        memcpy(m_data + m_pos, data, std::min<uint64_t>(size, m_capacity - m_pos));
+    }
+
+    m_pos += size;
+    m_size = std::max(m_size, m_pos);
+
+    return size;
 }
 
 size_t File::read(void* ptr, size_t size)
 {
-    assert(m_file != nullptr);
-    assert(m_mode == FM_READ);
-    return fread(ptr, 1u, size, m_file);
+    assert(m_mode != FM_WRITE);
+
+    switch (m_backend)
+    {
+    case FB_STDIO:
+    {
+        assert(m_file != nullptr);
+        return fread(ptr, 1u, size, m_file);
+    }
+    case FB_STREAM:
+    {
+        // streams such as pipes can return fewer bytes than requested before they end
+        size_t count = 0;
+
+        while (count != size)
+        {
+            auto r = static_cast<size_t>(m_stream.read(m_stream.user, static_cast<uint8_t*>(ptr) + count, size - count));
+
+            if (r == 0)
+            {
+                break;
+            }
+
+            count += r;
+        }
+
+        m_pos += count;
+
+        return count;
+    }
+    default:
+    {
+        size_t count;
+        const uint8_t* view = read_view(size, count);
+
+        if (count != 0)
+        {
+            memcpy(ptr, view, count);
+        }
+
+        return count;
+    }
+    }
+}
+
+const uint8_t* File::read_view(size_t size, size_t& count)
+{
+    if (m_backend != FB_MEMORY)
+    {
+        count = 0;
+        return nullptr;
+    }
+
+    count = static_cast<size_t>(std::min<uint64_t>(size, m_size - m_pos));
+
+    const uint8_t* view = m_data + m_pos;
+    m_pos += count;
+
+    return view;
+}
+
+bool File::seek(uint64_t offset)
+{
+    switch (m_backend)
+    {
+    case FB_STDIO:
+        assert(m_file != nullptr);
+        return pod_fseek(m_file, static_cast<int64_t>(offset), SEEK_SET) == 0;
+    case FB_STREAM:
+        if ((m_stream.seek == nullptr) || (m_stream.seek(m_stream.user, offset) != 0))
+        {
+            return false;
+        }
+
+        m_pos = offset;
+        return true;
+    default:
+        if (offset > m_size)
+        {
+            return false;
+        }
+
+        m_pos = offset;
+        return true;
+    }
+}
+
+uint64_t File::tell()
+{
+    if (m_backend == FB_STDIO)
+    {
+        assert(m_file != nullptr);
+        return static_cast<uint64_t>(pod_ftell(m_file));
+    }
+
+    return m_pos;
+}
+
+uint64_t File::size()
+{
+    switch (m_backend)
+    {
+    case FB_STDIO:
+    {
+        assert(m_file != nullptr);
+
+        auto offset = pod_ftell(m_file);
+
+        pod_fseek(m_file, 0, SEEK_END);
+        auto end = pod_ftell(m_file);
+        pod_fseek(m_file, offset, SEEK_SET);
+
+        return static_cast<uint64_t>(end);
+    }
+    case FB_STREAM:
+        // a stream that can't report its size has only the bytes written so far
+        return (m_stream.size != nullptr) ? m_stream.size(m_stream.user) : m_size;
+    default:
+        return m_size;
+    }
 }
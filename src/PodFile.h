@@ -4,12 +4,24 @@
 #ifndef POD_FILE_H
 #define POD_FILE_H
 
+#include "pod_io.h"
+
+#include <atomic>
 #include <fstream>
+#include <cstdint>
 
 enum FileMode
 {
     FM_READ,
     FM_WRITE,
+    FM_UPDATE,   // read and write an existing file
+};
+
+enum FileBackend
+{
+    FB_STDIO,    // FILE* opened by name
+    FB_MEMORY,   // bytes in memory
+    FB_STREAM,   // caller's pod_stream_t callbacks
 };
 
 class File
@@ -18,6 +30,18 @@ public:
 
     File(const char* filename, FileMode mode);
 
+    // Read from size bytes of memory, which must stay valid while the file is used
+    File(const uint8_t* data, uint64_t size);
+
+    // Write to memory
+    // if growable, the memory is allocated with malloc() as needed and data must be null (see release)
+    // otherwise bytes past capacity are dropped, but they are still counted by size()
+    File(uint8_t* data, uint64_t capacity, bool growable);
+
+    // Read or write through the callbacks of a stream
+    // the byte offset is tracked by the file, since the stream may not be able to seek
+    File(const pod_stream_t& stream, FileMode mode);
+
     File(const File&) = delete;
 
     File& operator=(const File&) = delete;
@@ -32,13 +56,63 @@ public:
     // returns the number of bytes read
     size_t read(void* ptr, size_t size);
 
+    // Read up to size bytes of a file in memory without copying them
+    // count is set to the number of bytes, which are valid while the file is
+    // returns null if the file isn't in memory
+    const uint8_t* read_view(size_t size, size_t& count);
+
+    // Move to an absolute byte offset
+    // returns true on success
+    bool seek(uint64_t offset);
+
+    // Returns the current byte offset
+    uint64_t tell();
+
+    // Returns the size of the file in bytes
+    // the current byte offset is not changed
+    uint64_t size();
+
     // Returns true if the file is open
     [[nodiscard]]
     bool is_open() const;
 
+    // Write any bytes buffered by the file
+    // returns false if a write has failed since the file was opened
+    bool flush();
+
+    // Returns true if seek() and size() are supported
+    [[nodiscard]]
+    bool can_seek() const;
+
+    // Returns true if a write has failed since the file was opened
+    [[nodiscard]]
+    bool failed() const;
+
+    // Returns true if the file was opened by name
+    [[nodiscard]]
+    bool is_named() const;
+
+    // Hint that the file will be read in order from the current offset
+    void advise_sequential();
+
+    // Take the memory of a growable file, which must be freed with free()
+    uint8_t* release();
+
 protected:
+    // Write data to a file in memory
+    size_t write_memory(const void* data, size_t size);
+
     FILE* m_file;
     FileMode m_mode;
+    FileBackend m_backend;
+    pod_stream_t m_stream;
+    std::atomic<bool> m_failed; // true if a write has failed (set by the thread that writes behind the caller)
+
+    bool m_growable;       // true if the memory is allocated by the file
+    uint8_t* m_data;       // memory of the file
+    uint64_t m_capacity;   // number of bytes of memory
+    uint64_t m_size;       // number of bytes in the file
+    uint64_t m_pos;        // current byte offset
 };
 
 #endif
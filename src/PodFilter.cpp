@@ -0,0 +1,303 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodFilter.h"
+#include "PodLookup.h"
+
+#include <cstring>
+
+// Transpose an 8x8 matrix of bits, where byte i is row i and bit j is column j
+static uint64_t transpose8(uint64_t x)
+{
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+    x = x ^ t ^ (t << 28);
+
+    return x;
+}
+
+// Byte b of every value is stored together, starting with byte 0
+static void shuffle_bytes(const uint8_t* in, uint8_t* out, size_t count, size_t size)
+{
+    for (size_t b = 0; b != size; ++b)
+    {
+        const uint8_t* src = in + b;
+        uint8_t* dst = out + b * count;
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            dst[i] = src[i * size];
+        }
+    }
+}
+
+static void unshuffle_bytes(const uint8_t* in, uint8_t* out, size_t count, size_t size)
+{
+    for (size_t b = 0; b != size; ++b)
+    {
+        const uint8_t* src = in + b * count;
+        uint8_t* dst = out + b;
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            dst[i * size] = src[i];
+        }
+    }
+}
+
+// Bit j of byte b of every value is stored together, in groups of 8 values
+// values that don't fill a group of 8 are stored after the groups without being shuffled
+static void shuffle_bits(const uint8_t* in, uint8_t* out, size_t count, size_t size)
+{
+    size_t groups = count / 8;
+
+    for (size_t g = 0; g != groups; ++g)
+    {
+        const uint8_t* src = in + g * 8 * size;
+
+        for (size_t b = 0; b != size; ++b)
+        {
+            uint64_t x = 0;
+
+            for (size_t i = 0; i != 8; ++i)
+            {
+                x |= static_cast<uint64_t>(src[i * size + b]) << (8 * i);
+            }
+
+            x = transpose8(x);
+
+            for (size_t j = 0; j != 8; ++j)
+            {
+                out[(b * 8 + j) * groups + g] = static_cast<uint8_t>(x >> (8 * j));
+            }
+        }
+    }
+
+    size_t done = groups * 8 * size;
+    memcpy(out + done, in + done, count * size - done);
+}
+
+static void unshuffle_bits(const uint8_t* in, uint8_t* out, size_t count, size_t size)
+{
+    size_t groups = count / 8;
+
+    for (size_t g = 0; g != groups; ++g)
+    {
+        uint8_t* dst = out + g * 8 * size;
+
+        for (size_t b = 0; b != size; ++b)
+        {
+            uint64_t x = 0;
+
+            for (size_t j = 0; j != 8; ++j)
+            {
+                x |= static_cast<uint64_t>(in[(b * 8 + j) * groups + g]) << (8 * j);
+            }
+
+            x = transpose8(x);
+
+            for (size_t i = 0; i != 8; ++i)
+            {
+                dst[i * size + b] = static_cast<uint8_t>(x >> (8 * i));
+            }
+        }
+    }
+
+    size_t done = groups * 8 * size;
+    memcpy(out + done, in + done, count * size - done);
+}
+
+// Load the value at index i as an unsigned integer
+template<class T>
+static T load(const uint8_t* values, size_t i)
+{
+    T value;
+    memcpy(&value, values + i * sizeof(T), sizeof(T));
+    return value;
+}
+
+template<class T>
+static void store(uint8_t* values, size_t i, T value)
+{
+    memcpy(values + i * sizeof(T), &value, sizeof(T));
+}
+
+template<class T>
+static void transform(uint32_t filter, const uint8_t* in, uint8_t* out, size_t count)
+{
+    T prev = 0;
+    T prevDelta = 0;
+
+    for (size_t i = 0; i != count; ++i)
+    {
+        T value = load<T>(in, i);
+        T delta = value - prev;
+
+        switch(filter & cFilterTransformMask)
+        {
+            case POD_FILTER_DELTA:
+                store<T>(out, i, delta);
+                break;
+            case POD_FILTER_DELTA2:
+                store<T>(out, i, static_cast<T>(delta - prevDelta));
+                break;
+            case POD_FILTER_XOR:
+                store<T>(out, i, static_cast<T>(value ^ prev));
+                break;
+        }
+
+        prev = value;
+        prevDelta = delta;
+    }
+}
+
+template<class T>
+static void untransform(uint32_t filter, uint8_t* values, size_t count)
+{
+    T prev = 0;
+    T prevDelta = 0;
+
+    for (size_t i = 0; i != count; ++i)
+    {
+        T code = load<T>(values, i);
+        T value = 0;
+
+        switch(filter & cFilterTransformMask)
+        {
+            case POD_FILTER_DELTA:
+                value = prev + code;
+                break;
+            case POD_FILTER_DELTA2:
+                value = prev + prevDelta + code;
+                break;
+            case POD_FILTER_XOR:
+                value = prev ^ code;
+                break;
+        }
+
+        store<T>(values, i, value);
+
+        prevDelta = value - prev;
+        prev = value;
+    }
+}
+
+bool is_valid_filter(uint32_t filter)
+{
+    if ((filter & ~(cFilterShuffleMask | cFilterTransformMask)) != 0)
+    {
+        return false;
+    }
+
+    uint32_t shuffle = filter & cFilterShuffleMask;
+    uint32_t transform = filter & cFilterTransformMask;
+
+    return
+        ((shuffle == POD_FILTER_NONE) || (shuffle == POD_FILTER_SHUFFLE) || (shuffle == POD_FILTER_BITSHUFFLE)) &&
+        ((transform == POD_FILTER_NONE) || (transform == POD_FILTER_DELTA) || (transform == POD_FILTER_DELTA2) || (transform == POD_FILTER_XOR));
+}
+
+bool has_shuffle(uint32_t filter)
+{
+    return (filter & cFilterShuffleMask) != 0;
+}
+
+bool has_transform(uint32_t filter)
+{
+    return (filter & cFilterTransformMask) != 0;
+}
+
+void apply_filter(uint32_t filter, const uint8_t* in, uint8_t* out, size_t count, size_t size)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    switch(filter & cFilterShuffleMask)
+    {
+        case POD_FILTER_SHUFFLE:
+            shuffle_bytes(in, out, count, size);
+            break;
+        case POD_FILTER_BITSHUFFLE:
+            shuffle_bits(in, out, count, size);
+            break;
+        default:
+            memcpy(out, in, count * size);
+            break;
+    }
+}
+
+void remove_filter(uint32_t filter, const uint8_t* in, uint8_t* out, size_t count, size_t size)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    switch(filter & cFilterShuffleMask)
+    {
+        case POD_FILTER_SHUFFLE:
+            unshuffle_bytes(in, out, count, size);
+            break;
+        case POD_FILTER_BITSHUFFLE:
+            unshuffle_bits(in, out, count, size);
+            break;
+        default:
+            memcpy(out, in, count * size);
+            break;
+    }
+}
+
+void apply_transform(uint32_t filter, const uint8_t* in, uint8_t* out, size_t count, size_t size)
+{
+    if (!has_transform(filter))
+    {
+        return;
+    }
+
+    switch(size)
+    {
+        case 1:
+            transform<uint8_t>(filter, in, out, count);
+            break;
+        case 2:
+            transform<uint16_t>(filter, in, out, count);
+            break;
+        case 4:
+            transform<uint32_t>(filter, in, out, count);
+            break;
+        case 8:
+            transform<uint64_t>(filter, in, out, count);
+            break;
+    }
+}
+
+void remove_transform(uint32_t filter, uint8_t* values, size_t count, size_t size)
+{
+    if (!has_transform(filter))
+    {
+        return;
+    }
+
+    switch(size)
+    {
+        case 1:
+            untransform<uint8_t>(filter, values, count);
+            break;
+        case 2:
+            untransform<uint16_t>(filter, values, count);
+            break;
+        case 4:
+            untransform<uint32_t>(filter, values, count);
+            break;
+        case 8:
+            untransform<uint64_t>(filter, values, count);
+            break;
+    }
+}
@@ -0,0 +1,36 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_FILTER_H
+#define POD_FILTER_H
+
+#include "pod_io.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Returns true if filter is a valid combination of pod_filter_t values
+bool is_valid_filter(uint32_t filter);
+
+// Returns true if filter has a shuffle filter
+bool has_shuffle(uint32_t filter);
+
+// Returns true if filter has a transform
+bool has_transform(uint32_t filter);
+
+// Apply the shuffle filter of filter to count values of size bytes
+// in and out must not overlap
+void apply_filter(uint32_t filter, const uint8_t* in, uint8_t* out, size_t count, size_t size);
+
+// Undo a shuffle filter that was applied by apply_filter
+// in and out must not overlap
+void remove_filter(uint32_t filter, const uint8_t* in, uint8_t* out, size_t count, size_t size);
+
+// Apply the transform of filter to count values of size bytes in the byte order of the host
+// in and out must not overlap
+void apply_transform(uint32_t filter, const uint8_t* in, uint8_t* out, size_t count, size_t size);
+
+// Undo a transform that was applied by apply_transform, in place
+void remove_transform(uint32_t filter, uint8_t* values, size_t count, size_t size);
+
+#endif
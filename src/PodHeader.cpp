@@ -0,0 +1,354 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodHeader.h"
+#include "PodBytes.h"
+#include "PodChecksum.h"
+#include "PodCodec.h"
+#include "PodConfig.h"
+#include "PodLookup.h"
+#include "PodPipeline.h"
+#include "PodThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Returns the format options of a header with a codec tag
+static uint32_t get_flags(const uint8_t* bytes)
+{
+    uint32_t flags;
+    memcpy(&flags, bytes + 16, 4);
+
+    pod_endian_t endian = (memcmp(bytes + 4, cBIGE, 4) == 0) ? POD_ENDIAN_BIG : POD_ENDIAN_LITTLE;
+
+    if (requires_byte_swap(endian))
+    {
+        flags = k13::byteswap<uint32_t>(flags);
+    }
+
+    return flags;
+}
+
+pod_result_t read_header(File& file, PodHeader& header, pod_checksum_t checksum, uint32_t& checksumValue)
+{
+    uint8_t bytes[cBlockAlignment];
+
+    if (file.read(bytes, 16) != 16)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Format options follow any reserved tag other than NONE
+
+    size_t size = 16;
+
+    if (memcmp(bytes + 12, cNONE, 4) != 0)
+    {
+        size = file.read(bytes + 16, 4) + 16;
+
+        // aligned headers are padded with zeros
+        if ((size == 20) && ((get_flags(bytes) & POD_FLAGS_ALIGN) != 0))
+        {
+            size += file.read(bytes + 20, cBlockAlignment - 20);
+        }
+    }
+
+    return read_header(bytes, size, header, checksum, checksumValue);
+}
+
+pod_result_t read_header(const uint8_t* bytes, size_t size, PodHeader& header, pod_checksum_t checksum, uint32_t& checksumValue)
+{
+    if (size < 16)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // PODX
+
+    if (memcmp(bytes, cPODX, 4) != 0)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Endianness
+
+    if (memcmp(bytes + 4, cLITE, 4) == 0)
+    {
+        header.endian = POD_ENDIAN_LITTLE;
+    }
+    else if (memcmp(bytes + 4, cBIGE, 4) == 0)
+    {
+        header.endian = POD_ENDIAN_BIG;
+    }
+    else
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Checksum
+
+    if (memcmp(bytes + 8, cCR32, 4) == 0)
+    {
+        header.checksum = POD_CHECKSUM_CRC32;
+    }
+    else if (memcmp(bytes + 8, cAD32, 4) == 0)
+    {
+        header.checksum = POD_CHECKSUM_ADLER32;
+    }
+    else if (memcmp(bytes + 8, cC32C, 4) == 0)
+    {
+        header.checksum = POD_CHECKSUM_CRC32C;
+    }
+    else if (memcmp(bytes + 8, cNONE, 4) == 0)
+    {
+        header.checksum = POD_CHECKSUM_NONE;
+    }
+    else
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    if (header.checksum != checksum)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Reserved
+    // NONE is the original format
+    // any other tag names the codec of the body (see PodCodec.h) and is followed by 4 bytes of format options
+
+    if (memcmp(bytes + 12, cNONE, 4) == 0)
+    {
+        header.flags = POD_FLAGS_NONE;
+        header.codec = CODEC_DEFLATE;
+        header.size = 16;
+    }
+    else if (find_codec(bytes + 12, header.codec))
+    {
+        if (size < 20)
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        uint32_t flags = get_flags(bytes);
+
+        // appended segments and block checksums are only found through the index
+        bool unindexed = ((flags & (POD_FLAGS_APPEND | POD_FLAGS_BLOCK_CHECKSUM)) != 0) && ((flags & POD_FLAGS_INDEX) == 0);
+
+        // block checksums use the checksum type of the file
+        bool unchecked = ((flags & POD_FLAGS_BLOCK_CHECKSUM) != 0) && (header.checksum == POD_CHECKSUM_NONE);
+
+        if (((flags & ~cFlagsMask) != 0) || unindexed || unchecked)
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        header.flags = static_cast<pod_flags_t>(flags);
+        header.size = ((flags & POD_FLAGS_ALIGN) != 0) ? cBlockAlignment : 20;
+
+        if (size < header.size)
+        {
+            return POD_FILE_CORRUPT;
+        }
+    }
+    else
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    checksumValue = checksum_update(checksum, checksumValue, bytes, header.size);
+
+    return POD_SUCCESS;
+}
+
+pod_result_t write_header(File& file, PodHeader& header, pod_endian_t endianness, pod_checksum_t checksum, compress_codec codec, pod_flags_t flags, uint32_t& checksumValue)
+{
+    uint8_t bytes[cBlockAlignment] = {};
+
+    // PODX
+
+    memcpy(bytes, cPODX, 4);
+
+    // Endian
+
+    switch(endianness)
+    {
+        case POD_ENDIAN_LITTLE:
+            header.endian = POD_ENDIAN_LITTLE;
+            break;
+        case POD_ENDIAN_BIG:
+            header.endian = POD_ENDIAN_BIG;
+            break;
+        case POD_ENDIAN_NATIVE:
+            if (is_little_endian())
+            {
+                header.endian = POD_ENDIAN_LITTLE;
+            }
+            else if (is_big_endian())
+            {
+                header.endian = POD_ENDIAN_BIG;
+            }
+            else
+            {
+                return POD_ARGUMENT_ERROR;
+            }
+            break;
+        default:
+            return POD_ARGUMENT_ERROR;
+    }
+
+    memcpy(bytes + 4, (header.endian == POD_ENDIAN_LITTLE) ? cLITE : cBIGE, 4);
+
+    // Checksum
+
+    switch(checksum)
+    {
+        case POD_CHECKSUM_NONE:
+            memcpy(bytes + 8, cNONE, 4);
+            break;
+        case POD_CHECKSUM_ADLER32:
+            memcpy(bytes + 8, cAD32, 4);
+            break;
+        case POD_CHECKSUM_CRC32:
+            memcpy(bytes + 8, cCR32, 4);
+            break;
+        case POD_CHECKSUM_CRC32C:
+            memcpy(bytes + 8, cC32C, 4);
+            break;
+        default:
+            return POD_ARGUMENT_ERROR;
+    }
+
+    header.checksum = checksum;
+
+    // Reserved
+
+    if ((flags & ~cFlagsMask) != 0)
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    if ((flags & (POD_FLAGS_APPEND | POD_FLAGS_BLOCK_CHECKSUM)) != 0)
+    {
+        flags = static_cast<pod_flags_t>(flags | POD_FLAGS_INDEX);
+    }
+
+    if (((flags & POD_FLAGS_BLOCK_CHECKSUM) != 0) && (checksum == POD_CHECKSUM_NONE))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    header.flags = flags;
+    header.codec = codec;
+
+    if (codec == CODEC_DEFLATE && flags == POD_FLAGS_NONE)
+    {
+        memcpy(bytes + 12, cNONE, 4);
+        header.size = 16;
+    }
+    else
+    {
+        memcpy(bytes + 12, get_codec(codec).tag, 4);
+
+        uint32_t value = flags;
+
+        if (requires_byte_swap(header.endian))
+        {
+            value = k13::byteswap<uint32_t>(value);
+        }
+
+        memcpy(bytes + 16, &value, 4);
+        header.size = ((flags & POD_FLAGS_ALIGN) != 0) ? cBlockAlignment : 20;
+    }
+
+    file.write(bytes, header.size);
+
+    checksumValue = checksum_update(checksum, checksumValue, bytes, header.size);
+
+    return POD_SUCCESS;
+}
+
+size_t checksum_size(pod_checksum_t checksum)
+{
+    return (checksum == POD_CHECKSUM_NONE) ? 0 : 4;
+}
+
+pod_result_t verify_checksum(File& file, const PodHeader& header, uint32_t checksumValue)
+{
+    if (header.checksum == POD_CHECKSUM_NONE)
+    {
+        return POD_SUCCESS;
+    }
+
+    uint64_t fileSize = file.size();
+
+    if ((fileSize < header.size + 4) || !file.seek(header.size))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    uint64_t remaining = fileSize - header.size - 4;
+    size_t bufferSize = config_io_buffer_size();
+
+    if (file.is_named() && (bufferSize != 0) && (remaining > bufferSize))
+    {
+        // the next chunk is read while the current one is checksummed, in spans across the threads
+
+        size_t threadCount = config_thread_count();
+        ThreadPool pool((threadCount > 1) ? threadCount : 0);
+        ReadAhead reader(file, remaining, bufferSize);
+
+        while (remaining != 0)
+        {
+            size_t size;
+            const uint8_t* chunk = reader.next(size);
+
+            if (size == 0)
+            {
+                return POD_FILE_CORRUPT;
+            }
+
+            checksumValue = checksum_update_parallel(header.checksum, checksumValue, chunk, size, pool);
+            remaining -= size;
+        }
+    }
+    else
+    {
+        std::vector<uint8_t> buffer(static_cast<size_t>(std::min<uint64_t>(remaining, 1u << 16)));
+
+        while (remaining != 0)
+        {
+            size_t size = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+
+            if (file.read(buffer.data(), size) != size)
+            {
+                return POD_FILE_CORRUPT;
+            }
+
+            checksumValue = checksum_update(header.checksum, checksumValue, buffer.data(), size);
+            remaining -= size;
+        }
+    }
+
+    uint32_t fileCheck32;
+
+    if (file.read(&fileCheck32, 4) != 4)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    if (requires_byte_swap(header.endian))
+    {
+        fileCheck32 = k13::byteswap<uint32_t>(fileCheck32);
+    }
+
+    return (fileCheck32 == checksumValue) ? POD_SUCCESS : POD_FILE_CORRUPT;
+}
+
+bool requires_byte_swap(pod_endian_t endian)
+{
+    return
+        (endian == POD_ENDIAN_LITTLE && is_big_endian()) ||
+        (endian == POD_ENDIAN_BIG && is_little_endian());
+}
@@ -0,0 +1,52 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_HEADER_H
+#define POD_HEADER_H
+
+#include "pod_io.h"
+#include "PodFile.h"
+#include "PodDeflate.h"
+
+#include <cstdint>
+
+struct PodHeader
+{
+    pod_endian_t endian;       // endianness of the file (little or big, never native)
+    pod_checksum_t checksum;   // checksum type
+    pod_flags_t flags;         // format options
+    compress_codec codec;      // codec of the body
+    uint64_t size;             // size of the header in bytes
+};
+
+// Read and validate a header
+// checksumValue is updated with the header bytes
+// returns POD_SUCCESS on success
+// and POD_FILE_CORRUPT if the header is invalid or doesn't match checksum
+pod_result_t read_header(File& file, PodHeader& header, pod_checksum_t checksum, uint32_t& checksumValue);
+
+// Read and validate a header from the first size bytes of a file held in memory
+pod_result_t read_header(const uint8_t* bytes, size_t size, PodHeader& header, pod_checksum_t checksum, uint32_t& checksumValue);
+
+// Write a header
+// endianness is resolved to little or big endian
+// the original format (reserved NONE) is written for CODEC_DEFLATE without flags
+// POD_FLAGS_APPEND adds POD_FLAGS_INDEX to the flags
+// checksumValue is updated with the header bytes
+// returns POD_SUCCESS on success
+// and POD_ARGUMENT_ERROR if an option is invalid
+pod_result_t write_header(File& file, PodHeader& header, pod_endian_t endianness, pod_checksum_t checksum, compress_codec codec, pod_flags_t flags, uint32_t& checksumValue);
+
+// Check the trailing checksum of a file without inflating it
+// checksumValue must already be updated with the header bytes
+// returns POD_SUCCESS on success
+// and POD_FILE_CORRUPT if the checksum doesn't match
+pod_result_t verify_checksum(File& file, const PodHeader& header, uint32_t checksumValue);
+
+// Returns the number of trailing checksum bytes
+size_t checksum_size(pod_checksum_t checksum);
+
+// Returns true if values stored in endian must be byte swapped on this host
+bool requires_byte_swap(pod_endian_t endian);
+
+#endif
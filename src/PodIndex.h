@@ -0,0 +1,275 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_INDEX_H
+#define POD_INDEX_H
+
+#include "pod_io.h"
+#include "PodBytes.h"
+#include "PodHeader.h"
+#include "PodFile.h"
+#include "PodFilter.h"
+#include "PodLookup.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// An entry in the block index
+struct PodIndexEntry
+{
+    std::string key;           // item key
+    uint64_t offset;           // file offset of the item's block in the deflate stream
+    uint64_t count;            // number of values
+    pod_type_t type;           // type of values
+    uint32_t filter;           // filter of the block (pod_filter_t)
+    uint64_t size = 0;         // number of stored bytes in the block (POD_FLAGS_BLOCK_CHECKSUM only)
+    uint32_t check32 = 0;      // checksum of the stored bytes of the block (POD_FLAGS_BLOCK_CHECKSUM only)
+};
+
+// Returns the size of an index entry without its key
+inline size_t index_entry_size(pod_flags_t flags)
+{
+    size_t size = ((flags & POD_FLAGS_COUNT64) != 0) ? 32 : 24;
+
+    return ((flags & POD_FLAGS_BLOCK_CHECKSUM) != 0) ? size + 16 : size;
+}
+
+// Encode the block index and its footer
+//    [8] entry count
+//    entries
+//        [8] block offset
+//        [4] key size
+//        [4] value count
+//        [4] type
+//        [4] filter (0 unless the file is saved with POD_FLAGS_FILTER)
+//        [?] key padded to a multiple of 8 bytes
+//    [8] index offset (footer)
+// with POD_FLAGS_COUNT64, entries are
+//        [8] block offset
+//        [4] key size
+//        [4] type
+//        [8] value count
+//        [4] filter
+//        [4] reserved (0)
+//        [?] key padded to a multiple of 8 bytes
+// with POD_FLAGS_BLOCK_CHECKSUM, entries have 16 more bytes before the key
+//        [8] stored size of the block
+//        [4] checksum of the stored bytes of the block
+//        [4] reserved (0)
+template<bool reverse_bytes>
+void encode_index(std::vector<uint8_t>& buffer, const std::vector<PodIndexEntry>& index, uint64_t indexOffset, pod_flags_t flags)
+{
+    bool count64 = (flags & POD_FLAGS_COUNT64) != 0;
+    bool checked = (flags & POD_FLAGS_BLOCK_CHECKSUM) != 0;
+    size_t entrySize = index_entry_size(flags);
+    size_t checkPos = entrySize - 16;
+    size_t size = 16;
+
+    for (const auto& entry : index)
+    {
+        size += entrySize + next_multiple_of(entry.key.size(), 8);
+    }
+
+    buffer.resize(size);
+
+    set_bytes<uint64_t, reverse_bytes>(buffer, static_cast<uint64_t>(index.size()), 0, 8);
+
+    size_t pos = 8;
+
+    for (const auto& entry : index)
+    {
+        size_t keySize = entry.key.size();
+        size_t paddedKeySize = next_multiple_of(keySize, 8);
+
+        set_bytes<uint64_t, reverse_bytes>(buffer, entry.offset, pos, 8);
+        set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(keySize), pos + 8, 4);
+
+        if (count64)
+        {
+            set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(entry.type), pos + 12, 4);
+            set_bytes<uint64_t, reverse_bytes>(buffer, entry.count, pos + 16, 8);
+            set_bytes<uint32_t, reverse_bytes>(buffer, entry.filter, pos + 24, 4);
+            set_bytes<uint32_t, reverse_bytes>(buffer, 0u, pos + 28, 4);
+        }
+        else
+        {
+            set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(entry.count), pos + 12, 4);
+            set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(entry.type), pos + 16, 4);
+            set_bytes<uint32_t, reverse_bytes>(buffer, entry.filter, pos + 20, 4);
+        }
+
+        if (checked)
+        {
+            set_bytes<uint64_t, reverse_bytes>(buffer, entry.size, pos + checkPos, 8);
+            set_bytes<uint32_t, reverse_bytes>(buffer, entry.check32, pos + checkPos + 8, 4);
+            set_bytes<uint32_t, reverse_bytes>(buffer, 0u, pos + checkPos + 12, 4);
+        }
+
+        set_bytes<uint8_t , reverse_bytes>(buffer, entry.key.data(), pos + entrySize, keySize);
+        pad_bytes(buffer, pos + entrySize + keySize, paddedKeySize - keySize);
+
+        pos += entrySize + paddedKeySize;
+    }
+
+    set_bytes<uint64_t, reverse_bytes>(buffer, indexOffset, pos, 8);
+}
+
+// Read the index offset from the footer at the end of a file
+// the file position is left after the footer
+// returns false if the footer is corrupt
+template<bool reverse_bytes>
+bool read_index_offset(File& file, const PodHeader& header, uint64_t& indexOffset)
+{
+    std::vector<uint8_t> buffer(8);
+
+    uint64_t fileSize = file.size();
+    uint64_t trailerSize = checksum_size(header.checksum) + 8;
+
+    if (fileSize < header.size + trailerSize)
+    {
+        return false;
+    }
+
+    uint64_t footer = fileSize - trailerSize;
+
+    if (!file.seek(footer) || (file.read(buffer.data(), 8) != 8))
+    {
+        return false;
+    }
+
+    get_bytes<uint64_t, reverse_bytes>(indexOffset, buffer, 0, 8);
+
+    return (indexOffset >= header.size) && (indexOffset <= footer);
+}
+
+// Decode a block index and its footer
+// buffer contains every byte from the index offset up to the trailing checksum
+// returns false if the index is corrupt
+template<bool reverse_bytes>
+bool decode_index(std::vector<PodIndexEntry>& index, std::vector<uint8_t>& buffer, uint64_t indexOffset, pod_flags_t flags)
+{
+    if ((buffer.size() < 16) || ((buffer.size() % 8) != 0))
+    {
+        return false;
+    }
+
+    uint64_t entryCount, footer;
+
+    get_bytes<uint64_t, reverse_bytes>(entryCount, buffer, 0, 8);
+    get_bytes<uint64_t, reverse_bytes>(footer, buffer, buffer.size() - 8, 8);
+
+    if (footer != indexOffset)
+    {
+        return false;
+    }
+
+    bool count64 = (flags & POD_FLAGS_COUNT64) != 0;
+    bool checked = (flags & POD_FLAGS_BLOCK_CHECKSUM) != 0;
+    size_t entrySize = index_entry_size(flags);
+    size_t checkPos = entrySize - 16;
+    size_t end = buffer.size() - 8;
+
+    if (entryCount > (end - 8) / entrySize)
+    {
+        return false;
+    }
+
+    index.resize(entryCount);
+
+    size_t pos = 8;
+
+    for (auto& entry : index)
+    {
+        if (end - pos < entrySize)
+        {
+            return false;
+        }
+
+        uint32_t keySize, rawType;
+
+        get_bytes<uint64_t, reverse_bytes>(entry.offset, buffer, pos, 8);
+        get_bytes<uint32_t, reverse_bytes>(keySize, buffer, pos + 8, 4);
+
+        if (count64)
+        {
+            get_bytes<uint32_t, reverse_bytes>(rawType, buffer, pos + 12, 4);
+            get_bytes<uint64_t, reverse_bytes>(entry.count, buffer, pos + 16, 8);
+            get_bytes<uint32_t, reverse_bytes>(entry.filter, buffer, pos + 24, 4);
+        }
+        else
+        {
+            uint32_t count32;
+
+            get_bytes<uint32_t, reverse_bytes>(count32, buffer, pos + 12, 4);
+            get_bytes<uint32_t, reverse_bytes>(rawType, buffer, pos + 16, 4);
+            get_bytes<uint32_t, reverse_bytes>(entry.filter, buffer, pos + 20, 4);
+
+            entry.count = count32;
+        }
+
+        if (checked)
+        {
+            get_bytes<uint64_t, reverse_bytes>(entry.size, buffer, pos + checkPos, 8);
+            get_bytes<uint32_t, reverse_bytes>(entry.check32, buffer, pos + checkPos + 8, 4);
+
+            // the block must end before the index
+            if ((entry.size == 0) || (entry.size > indexOffset - std::min(entry.offset, indexOffset)))
+            {
+                return false;
+            }
+        }
+
+        if (!to_pod_type(rawType, entry.type) || !is_valid_filter(entry.filter) || (entry.offset >= indexOffset) || (entry.count > MaxCountLookup[size_of_type(entry.type)]))
+        {
+            return false;
+        }
+
+        pos += entrySize;
+
+        size_t paddedKeySize = next_multiple_of(keySize, 8);
+
+        if (end - pos < paddedKeySize)
+        {
+            return false;
+        }
+
+        entry.key.assign(reinterpret_cast<const char*>(buffer.data() + pos), keySize);
+
+        pos += paddedKeySize;
+    }
+
+    return pos == end;
+}
+
+// Read and decode the block index of a file
+// indexOffset is set to the file offset of the index
+// returns POD_SUCCESS on success
+// and POD_FILE_CORRUPT if the index is corrupt
+template<bool reverse_bytes>
+pod_result_t read_index(std::vector<PodIndexEntry>& index, File& file, const PodHeader& header, uint64_t& indexOffset)
+{
+    if (!read_index_offset<reverse_bytes>(file, header, indexOffset))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Read index
+
+    size_t indexSize = file.size() - checksum_size(header.checksum) - indexOffset;
+    std::vector<uint8_t> buffer(indexSize);
+
+    if (!file.seek(indexOffset) || (file.read(buffer.data(), indexSize) != indexSize))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    if (!decode_index<reverse_bytes>(index, buffer, indexOffset, header.flags))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    return POD_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,130 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+#include "PodLazy.h"
+#include "PodBlock.h"
+#include "PodIndex.h"
+#include "PodTypes.h"
+
+#include <memory>
+
+pod_result_t load_values(const PodData& data)
+{
+    if (data.lazy == nullptr)
+    {
+        return POD_SUCCESS;
+    }
+
+    auto& lazy = *data.lazy;
+
+    std::lock_guard<std::mutex> lock(lazy.mutex);
+
+    if (!data.pending)
+    {
+        return POD_SUCCESS;
+    }
+
+    // the values are a cache of the file, so they are filled in through const items
+    auto& mutableData = const_cast<PodData&>(data);
+
+    std::string key;
+
+    pod_result_t result = catch_alloc([&]()
+    {
+        if (requires_byte_swap(lazy.header.endian))
+        {
+            return read_block_at<true>(lazy.file, lazy.header, data.offset, lazy.indexOffset, data.storedSize, data.check32, lazy.buffer, key, mutableData);
+        }
+        else
+        {
+            return read_block_at<false>(lazy.file, lazy.header, data.offset, lazy.indexOffset, data.storedSize, data.check32, lazy.buffer, key, mutableData);
+        }
+    });
+
+    if (result != POD_SUCCESS)
+    {
+        mutableData.values.clear();
+        return result;
+    }
+
+    mutableData.pending = false;
+
+    return POD_SUCCESS;
+}
+
+template<bool reverse_bytes>
+pod_result_t readLazy(pod_container_t* container, const std::shared_ptr<LazyFile>& lazy)
+{
+    auto& map = container->map;
+
+    std::vector<PodIndexEntry> index;
+
+    pod_result_t result = read_index<reverse_bytes>(index, lazy->file, lazy->header, lazy->indexOffset);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    for (auto& entry : index)
+    {
+        auto& data = map[entry.key];
+        data.release();
+        data.values.clear();
+        data.count = entry.count;
+        data.type = entry.type;
+        data.filter = entry.filter;
+        data.lazy = lazy;
+        data.offset = entry.offset;
+        data.storedSize = entry.size;
+        data.check32 = entry.check32;
+        data.pending = (entry.count != 0);
+    }
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_load_file_lazy(pod_container_t* container, const char* fileName, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    if (container == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    auto lazy = std::make_shared<LazyFile>(fileName);
+
+    if (!lazy->file.is_open())
+    {
+        return POD_FILE_NOT_FOUND;
+    }
+
+    uint32_t headerChecksumValue = checksumValue;
+
+    pod_result_t result = read_header(lazy->file, lazy->header, checksum, headerChecksumValue);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // Without an index every block has to be inflated to find the next one
+
+    if ((lazy->header.flags & POD_FLAGS_INDEX) == 0)
+    {
+        lazy.reset();
+        return pod_load_file(container, fileName, checksum, checksumValue);
+    }
+
+    return catch_alloc([&]()
+    {
+        if (requires_byte_swap(lazy->header.endian))
+        {
+            return readLazy<true>(container, lazy);
+        }
+        else
+        {
+            return readLazy<false>(container, lazy);
+        }
+    });
+}
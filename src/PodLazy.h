@@ -0,0 +1,37 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_LAZY_H
+#define POD_LAZY_H
+
+#include "pod_io.h"
+#include "PodFile.h"
+#include "PodHeader.h"
+#include "PodTypes.h"
+
+#include <mutex>
+#include <vector>
+
+// An indexed file that items inflate their values from on first access
+struct LazyFile
+{
+    explicit LazyFile(const char* fileName)
+        : file(fileName, FM_READ)
+        , header()
+        , indexOffset(0)
+    {}
+
+    File file;                    // file handle kept open for the items
+    PodHeader header;             // header of the file
+    uint64_t indexOffset;         // offset of the index (the end of the body)
+    std::mutex mutex;             // guards the file and every pending flag
+    std::vector<uint8_t> buffer;  // temporary buffer used for inflating
+};
+
+// Inflate the values of an item loaded by pod_load_file_lazy
+// does nothing if the values are already available
+// returns POD_SUCCESS on success
+// and POD_FILE_CORRUPT if the block is corrupt
+pod_result_t load_values(const PodData& data);
+
+#endif
@@ -2,66 +2,124 @@
 // Kyle J Burgess
 
 #include "pod_io.h"
+#include "PodBlock.h"
 #include "PodBytes.h"
 #include "PodTypes.h"
 #include "PodDeflate.h"
-#include "PodLookup.h"
+#include "PodHeader.h"
+#include "PodIndex.h"
+#include "PodChecksum.h"
+#include "PodConfig.h"
+#include "PodParallelInflate.h"
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-template<bool reverse_bytes>
-pod_result_t readBytes(pod_container_t* container, File& file, pod_checksum_t checksum, uint32_t check32)
+// Stores every block in a container
+struct container_visitor
 {
-    int r;
-    auto& map = container->map;
+    PodMap& map;
 
-    // Start inflating
+    PodData& item(const std::string& key)
+    {
+        auto& data = map[key];
+        data.release();
+        return data;
+    }
 
-    compress_stream is {};
-    if (inflate_init(is, &file, checksum, check32) != COMPRESS_SUCCESS)
+    pod_result_t visit(const std::string&, const PodData&)
     {
-        return POD_ZLIB_ERROR;
+        return POD_SUCCESS;
     }
+};
 
-    std::vector<uint8_t> buffer;
+// Hands every block to a callback, reusing one item for the values
+struct callback_visitor
+{
+    pod_visit_callback_t callback;
+    void* user;
+    PodData scratch;
 
-    // Get Value Groups
-    while (true)
+    PodData& item(const std::string&)
+    {
+        return scratch;
+    }
+
+    pod_result_t visit(const std::string& key, const PodData& data)
+    {
+        return callback(key.c_str(), key.size(), data.type, data.count, data.data(), user);
+    }
+};
+
+// Inflate the body of a file in order
+// visitor.item(key) returns the item that a block's values are inflated into,
+// then visitor.visit(key, item) is called once they are,
+// and reading stops at the first result other than POD_SUCCESS
+template<bool reverse_bytes, class Visitor>
+pod_result_t readBytes(Visitor& visitor, File& file, const PodHeader& header, uint32_t check32)
+{
+    compress_result r;
+
+    bool indexed = (header.flags & POD_FLAGS_INDEX) != 0;
+
+    // Stored bytes end at the index, or at the checksum
+
+    uint64_t storedSize = 0;
+
+    if (header.codec == CODEC_STORE)
     {
-        // Inflate sizes
+        uint64_t fileSize = file.size();
 
-        buffer.resize(12);
-        r = inflate_next(is, buffer.data(), 12);
+        if (fileSize < header.size + checksum_size(header.checksum))
+        {
+            return POD_FILE_CORRUPT;
+        }
 
-        if (r == COMPRESS_STREAM_END)
+        uint64_t bodyEnd = fileSize - checksum_size(header.checksum);
+
+        if (indexed && !read_index_offset<reverse_bytes>(file, header, bodyEnd))
         {
-            break;
+            return POD_FILE_CORRUPT;
         }
 
-        if (r != COMPRESS_SUCCESS)
+        if ((bodyEnd < header.size) || !file.seek(header.size))
         {
-            inflate_end(is);
             return POD_FILE_CORRUPT;
         }
 
-        // Set sizes
+        storedSize = bodyEnd - header.size;
+    }
 
-        uint32_t strSize, rawType, valueCount;
+    // Start inflating
 
-        get_bytes<uint32_t, reverse_bytes>(strSize, buffer, 0, 4);
-        get_bytes<uint32_t, reverse_bytes>(valueCount, buffer, 4, 4);
-        get_bytes<uint32_t, reverse_bytes>(rawType, buffer, 8, 4);
+    compress_stream is {};
+    if (inflate_init(is, &file, header.codec, storedSize, header.checksum, check32) != COMPRESS_SUCCESS)
+    {
+        return POD_ZLIB_ERROR;
+    }
 
-        // Inflate key
+    std::vector<uint8_t> buffer;
+    std::string key;
+    uint64_t valueCount;
+    uint32_t filter;
+    pod_type_t type;
+    size_t blockCount = 0;
 
-        buffer.resize(strSize);
-        r = inflate_next(is, buffer.data(), buffer.size());
+    // Get Value Groups
+    while (true)
+    {
+        // Inflate header and key
+
+        r = inflate_block_header<reverse_bytes>(is, buffer, key, valueCount, type, filter, header.flags);
 
         if (r == COMPRESS_STREAM_END)
         {
-            inflate_end(is);
-            return POD_FILE_CORRUPT;
+            break;
         }
 
         if (r != COMPRESS_SUCCESS)
@@ -70,166 +128,202 @@ pod_result_t readBytes(pod_container_t* container, File& file, pod_checksum_t ch
             return POD_FILE_CORRUPT;
         }
 
-        // Set key
-
-        std::string key;
-        key.assign(reinterpret_cast<char*>(buffer.data()), strSize);
-
         // Setup data
 
-        auto& data = map[key];
+        auto& data = visitor.item(key);
         data.count = valueCount;
+        data.type = type;
+        data.filter = filter;
 
-        switch (rawType)
-        {
-            case POD_ASCII_CHAR8:
-                data.type = POD_ASCII_CHAR8;
-                break;
-            case POD_UINT8:
-                data.type = POD_UINT8;
-                break;
-            case POD_UINT16:
-                data.type = POD_UINT16;
-                break;
-            case POD_UINT32:
-                data.type = POD_UINT32;
-                break;
-            case POD_UINT64:
-                data.type = POD_UINT64;
-                break;
-            case POD_INT8:
-                data.type = POD_INT8;
-                break;
-            case POD_INT16:
-                data.type = POD_INT16;
-                break;
-            case POD_INT32:
-                data.type = POD_INT32;
-                break;
-            case POD_INT64:
-                data.type = POD_INT64;
-                break;
-            case POD_FLOAT32:
-                data.type = POD_FLOAT32;
-                break;
-            case POD_FLOAT64:
-                data.type = POD_FLOAT64;
-                break;
-            default:
-                return POD_FILE_CORRUPT;
-        }
+        ++blockCount;
 
         // Inflate values
-        uint32_t blockSize = data.count * size_of_type(data.type);
+        // an item that can't be allocated is left empty, so it never has a count without values
 
-        data.values.resize(blockSize);
-
-        if constexpr (reverse_bytes)
+        try
         {
-            buffer.resize(data.values.size());
-            r = inflate_next(is, buffer.data(), buffer.size());
+            r = inflate_block_values<reverse_bytes>(is, buffer, data, header.flags);
         }
-        else
+        catch (const std::length_error&)
         {
-            r = inflate_next(is, data.values.data(), data.values.size());
+            data = PodData();
+            inflate_end(is);
+            return POD_OUT_OF_RANGE;
+        }
+        catch (const std::bad_alloc&)
+        {
+            data = PodData();
+            inflate_end(is);
+            return POD_OUT_OF_RANGE;
         }
 
-        if constexpr (reverse_bytes)
+        if (r == COMPRESS_ERROR)
         {
-            switch(data.type)
-            {
-                case POD_ASCII_CHAR8:
-                case POD_UINT8:
-                case POD_INT8:
-                    get_bytes<uint8_t , reverse_bytes>(data.values.data(), buffer, 0, buffer.size());
-                    break;
-                case POD_UINT16:
-                case POD_INT16:
-                    get_bytes<uint16_t, reverse_bytes>(data.values.data(), buffer, 0, buffer.size());
-                    break;
-                case POD_UINT32:
-                case POD_INT32:
-                case POD_FLOAT32:
-                    get_bytes<uint32_t, reverse_bytes>(data.values.data(), buffer, 0, buffer.size());
-                    break;
-                case POD_UINT64:
-                case POD_INT64:
-                case POD_FLOAT64:
-                    get_bytes<uint64_t, reverse_bytes>(data.values.data(), buffer, 0, buffer.size());
-                    break;
-                default:
-                    return POD_FILE_CORRUPT;
-            }
+            inflate_end(is);
+            return POD_FILE_CORRUPT;
+        }
+
+        pod_result_t result = visitor.visit(key, data);
+
+        if (result != POD_SUCCESS)
+        {
+            inflate_end(is);
+            return result;
         }
 
         if (r == COMPRESS_STREAM_END)
         {
             break;
         }
+    }
 
-        if (r != COMPRESS_SUCCESS)
+    if (inflate_end(is) != COMPRESS_SUCCESS)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Read trailer
+    // the inflate stream may have already read part of it (see inflate_read_back)
+
+    size_t readBackSize;
+    auto readBack = inflate_read_back(is, readBackSize);
+
+    uint64_t bodyEnd = file.tell() - readBackSize;
+    uint64_t trailerSize = checksum_size(header.checksum);
+
+    if (indexed)
+    {
+        uint64_t fileSize = file.size();
+
+        if (fileSize < bodyEnd + trailerSize)
         {
-            inflate_end(is);
             return POD_FILE_CORRUPT;
         }
+
+        trailerSize = fileSize - bodyEnd;
     }
 
-    if (inflate_end(is) != COMPRESS_SUCCESS)
+    if (readBackSize > trailerSize)
     {
         return POD_FILE_CORRUPT;
     }
 
-    // Read checksum
+    buffer.resize(trailerSize);
 
-    size_t size;
-    if (checksum == POD_CHECKSUM_NONE)
+    if (readBackSize != 0)
     {
-        inflate_read_back(is, size);
+        memcpy(buffer.data(), readBack, readBackSize);
+    }
+
+    // read the rest
+    if (readBackSize != trailerSize)
+    {
+        size_t ds = trailerSize - readBackSize;
 
-        if (size != 0)
+        if (file.read(buffer.data() + readBackSize, ds) != ds)
         {
             return POD_FILE_CORRUPT;
         }
     }
-    else
+
+    size_t indexSize = trailerSize - checksum_size(header.checksum);
+
+    if ((indexSize % 4) != 0)
     {
-        buffer.resize(4);
+        return POD_FILE_CORRUPT;
+    }
 
-        // get from inflate readback
-        auto ptr = inflate_read_back(is, size);
-        if (size != 0)
-        {
-            if (size > 4)
-            {
-                return POD_FILE_CORRUPT;
-            }
+    // Get checksum
 
-            memcpy(buffer.data(), ptr, size);
-        }
+    uint32_t fileCheck32 = 0;
 
-        // read the rest
-        if (size != 4)
-        {
-            size_t ds = 4 - size;
+    if (header.checksum != POD_CHECKSUM_NONE)
+    {
+        get_bytes<uint32_t, reverse_bytes>(fileCheck32, buffer, indexSize, 4);
+    }
 
-            if (file.read(buffer.data() + size, ds) != ds)
-            {
-                return POD_FILE_CORRUPT;
-            }
-        }
+    // Validate index
 
-        // get checksum
-        get_bytes<uint32_t, reverse_bytes>(check32, buffer, 0, 4);
+    check32 = is.check32;
 
-        if (check32 != is.check32)
+    if (indexed)
+    {
+        check32 = checksum_update(header.checksum, check32, buffer.data(), indexSize);
+
+        buffer.resize(indexSize);
+
+        std::vector<PodIndexEntry> index;
+
+        if (!decode_index<reverse_bytes>(index, buffer, bodyEnd, header.flags) || (index.size() != blockCount))
         {
             return POD_FILE_CORRUPT;
         }
     }
 
+    // Validate checksum
+
+    if ((header.checksum != POD_CHECKSUM_NONE) && (fileCheck32 != check32))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
     return POD_SUCCESS;
 }
 
+// Load a container from an open file
+static pod_result_t loadStream(pod_container_t* container, File& file, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    // Read header
+
+    PodHeader header;
+
+    pod_result_t result = read_header(file, header, checksum, checksumValue);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // the trailer of indexed files and the end of stored bytes are found from the end of the file
+    if ((((header.flags & POD_FLAGS_INDEX) != 0) || (header.codec == CODEC_STORE)) && !file.can_seek())
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    // Read bytes
+    // the blocks of indexed files can be inflated in parallel,
+    // and blocks with their own checksum are checked by the threads that inflate them
+
+    size_t threadCount = config_thread_count();
+
+    bool indexOnly = (header.flags & (POD_FLAGS_APPEND | POD_FLAGS_BLOCK_CHECKSUM)) != 0;
+
+    if (((header.flags & POD_FLAGS_INDEX) != 0) && ((threadCount > 1) || indexOnly))
+    {
+        if (requires_byte_swap(header.endian))
+        {
+            return readBytesParallel<true>(container, file, header, checksumValue, threadCount);
+        }
+        else
+        {
+            return readBytesParallel<false>(container, file, header, checksumValue, threadCount);
+        }
+    }
+
+    container_visitor visitor { container->map };
+
+    if (requires_byte_swap(header.endian))
+    {
+        result = readBytes<true>(visitor, file, header, checksumValue);
+    }
+    else
+    {
+        result = readBytes<false>(visitor, file, header, checksumValue);
+    }
+
+    return result;
+}
+
 pod_result_t pod_load_file(pod_container_t* container, const char* fileName, pod_checksum_t checksum, uint32_t checksumValue)
 {
     File file(fileName, FM_READ);
@@ -239,100 +333,213 @@ pod_result_t pod_load_file(pod_container_t* container, const char* fileName, pod
         return POD_FILE_NOT_FOUND;
     }
 
-    // Read header
+    return catch_alloc([&](){ return loadStream(container, file, checksum, checksumValue); });
+}
 
-    uint8_t header[16];
+pod_result_t pod_verify_file(const char* fileName, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    File file(fileName, FM_READ);
 
-    if (file.read(header, sizeof(header)) != sizeof(header))
+    if (!file.is_open())
     {
-        return POD_FILE_CORRUPT;
+        return POD_FILE_NOT_FOUND;
     }
 
-    // PODS
+    PodHeader header;
 
-    if (memcmp(header, cPODX, 4) != 0)
+    pod_result_t result = read_header(file, header, checksum, checksumValue);
+
+    if (result != POD_SUCCESS)
     {
-        return POD_FILE_CORRUPT;
+        return result;
     }
 
-    // Endianness
+    return verify_checksum(file, header, checksumValue);
+}
+
+pod_result_t pod_salvage_file(pod_container_t* container, const char* fileName, pod_checksum_t checksum, uint32_t checksumValue, pod_salvage_callback_t callback, void* user)
+{
+    if (container == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
 
-    pod_endian_t endian;
+    File file(fileName, FM_READ);
 
-    if (memcmp(header + 4, cLITE, 4) == 0)
+    if (!file.is_open())
     {
-        endian = POD_ENDIAN_LITTLE;
+        return POD_FILE_NOT_FOUND;
     }
-    else if (memcmp(header + 4, cBIGE, 4) == 0)
+
+    PodHeader header;
+
+    pod_result_t result = read_header(file, header, checksum, checksumValue);
+
+    if (result != POD_SUCCESS)
     {
-        endian = POD_ENDIAN_BIG;
+        return result;
     }
-    else
+
+    // only blocks with their own checksum can be told apart from the rest of the file
+
+    if ((header.flags & POD_FLAGS_BLOCK_CHECKSUM) == 0)
     {
-        return POD_FILE_CORRUPT;
+        return POD_ARGUMENT_ERROR;
     }
 
-    // Checksum
+    std::vector<std::string> corrupt;
 
-    if (memcmp(header + 8, cCR32, 4) == 0)
+    result = catch_alloc([&]()
     {
-        if (checksum != POD_CHECKSUM_CRC32)
+        if (requires_byte_swap(header.endian))
         {
-            return POD_FILE_CORRUPT;
+            return readBytesParallel<true>(container, file, header, checksumValue, config_thread_count(), &corrupt);
         }
-    }
-    else if (memcmp(header + 8, cAD32, 4) == 0)
-    {
-        if (checksum != POD_CHECKSUM_ADLER32)
+        else
         {
-            return POD_FILE_CORRUPT;
+            return readBytesParallel<false>(container, file, header, checksumValue, config_thread_count(), &corrupt);
         }
-    }
-    else if (memcmp(header + 8, cNONE, 4) == 0)
+    });
+
+    if (callback != nullptr)
     {
-        if (checksum != POD_CHECKSUM_NONE)
+        for (const auto& key : corrupt)
         {
-            return POD_FILE_CORRUPT;
+            callback(key.c_str(), key.size(), user);
         }
     }
-    else
+
+    return result;
+}
+
+pod_result_t pod_load_memory(pod_container_t* container, const void* buffer, uint64_t size, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    if ((container == nullptr) || (buffer == nullptr && size != 0))
     {
-        return POD_FILE_CORRUPT;
+        return POD_NULL_REFERENCE;
     }
 
-    // Reserved
-    if (memcmp(header + 12, cNONE, 4) != 0)
+    // the blocks are inflated straight from the buffer
+    File file(static_cast<const uint8_t*>(buffer), size);
+
+    return catch_alloc([&](){ return loadStream(container, file, checksum, checksumValue); });
+}
+
+pod_result_t pod_load_stream(pod_container_t* container, const pod_stream_t* stream, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    if ((container == nullptr) || (stream == nullptr))
     {
-        return POD_FILE_CORRUPT;
+        return POD_NULL_REFERENCE;
     }
 
-    // Calculate checksum
+    File file(*stream, FM_READ);
 
-    if (checksum == POD_CHECKSUM_ADLER32)
+    if (!file.is_open())
     {
-        checksumValue = adler32(checksumValue, header, 16);
+        return POD_FILE_NOT_FOUND;
     }
-    else if (checksum == POD_CHECKSUM_CRC32)
+
+    return catch_alloc([&](){ return loadStream(container, file, checksum, checksumValue); });
+}
+
+// Visit the blocks of a file saved with POD_FLAGS_APPEND or POD_FLAGS_BLOCK_CHECKSUM through its index, in file order
+template<bool reverse_bytes>
+pod_result_t visitIndexed(callback_visitor& visitor, File& file, const PodHeader& header, uint32_t check32)
+{
+    std::vector<PodIndexEntry> index;
+    uint64_t indexOffset;
+
+    pod_result_t result = read_index<reverse_bytes>(index, file, header, indexOffset);
+
+    if (result != POD_SUCCESS)
     {
-        checksumValue = crc32(checksumValue, header, 16);
+        return result;
     }
 
-    // Read bytes
+    std::sort(index.begin(), index.end(), [](const PodIndexEntry& a, const PodIndexEntry& b){ return a.offset < b.offset; });
+
+    std::vector<uint8_t> buffer;
+    std::string key;
+
+    for (const auto& entry : index)
+    {
+        auto& data = visitor.item(entry.key);
+        data.count = entry.count;
+        data.type = entry.type;
+        data.filter = entry.filter;
+
+        result = read_block_at<reverse_bytes>(file, header, entry.offset, indexOffset, entry.size, entry.check32, buffer, key, data);
 
-    bool requiresByteSwap =
-        (endian == POD_ENDIAN_LITTLE && is_big_endian()) ||
-        (endian == POD_ENDIAN_BIG && is_little_endian());
+        if ((result == POD_SUCCESS) && (key != entry.key))
+        {
+            result = POD_FILE_CORRUPT;
+        }
 
-    pod_result_t result;
+        if (result == POD_SUCCESS)
+        {
+            result = visitor.visit(key, data);
+        }
 
-    if (requiresByteSwap)
+        if (result != POD_SUCCESS)
+        {
+            return result;
+        }
+    }
+
+    return verify_checksum(file, header, check32);
+}
+
+pod_result_t pod_visit_file(const char* fileName, pod_checksum_t checksum, uint32_t checksumValue, pod_visit_callback_t callback, void* user)
+{
+    if (callback == nullptr)
     {
-        result = readBytes<true>(container, file, checksum, checksumValue);
+        return POD_NULL_REFERENCE;
     }
-    else
+
+    File file(fileName, FM_READ);
+
+    if (!file.is_open())
     {
-        result = readBytes<false>(container, file, checksum, checksumValue);
+        return POD_FILE_NOT_FOUND;
     }
 
-    return result;
+    // Read header
+
+    PodHeader header;
+
+    pod_result_t result = read_header(file, header, checksum, checksumValue);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    return catch_alloc([&]()
+    {
+        callback_visitor visitor { callback, user, PodData() };
+
+        // blocks of appended segments are only found through the index,
+        // and blocks with their own checksum are checked before they are visited
+
+        if ((header.flags & (POD_FLAGS_APPEND | POD_FLAGS_BLOCK_CHECKSUM)) != 0)
+        {
+            if (requires_byte_swap(header.endian))
+            {
+                return visitIndexed<true>(visitor, file, header, checksumValue);
+            }
+            else
+            {
+                return visitIndexed<false>(visitor, file, header, checksumValue);
+            }
+        }
+
+        if (requires_byte_swap(header.endian))
+        {
+            return readBytes<true>(visitor, file, header, checksumValue);
+        }
+        else
+        {
+            return readBytes<false>(visitor, file, header, checksumValue);
+        }
+    });
 }
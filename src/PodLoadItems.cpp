@@ -0,0 +1,161 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+#include "PodBlock.h"
+#include "PodBytes.h"
+#include "PodTypes.h"
+#include "PodDeflate.h"
+#include "PodHeader.h"
+#include "PodIndex.h"
+
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+template<bool reverse_bytes>
+pod_result_t readItems(pod_container_t* container, File& file, const PodHeader& header, const char* const* keys, uint32_t keyCount)
+{
+    auto& map = container->map;
+
+    std::vector<PodIndexEntry> index;
+    uint64_t indexOffset;
+
+    pod_result_t result = read_index<reverse_bytes>(index, file, header, indexOffset);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    std::unordered_map<std::string_view, const PodIndexEntry*> lookup;
+    lookup.reserve(index.size());
+
+    for (const auto& entry : index)
+    {
+        lookup[entry.key] = &entry;
+    }
+
+    std::vector<uint8_t> buffer;
+    std::string key;
+
+    for (uint32_t i = 0; i != keyCount; ++i)
+    {
+        if (keys[i] == nullptr)
+        {
+            return POD_NULL_REFERENCE;
+        }
+
+        auto it = lookup.find(keys[i]);
+
+        if (it == lookup.end())
+        {
+            continue;
+        }
+
+        const auto& entry = *it->second;
+
+        // Inflate the block on its own, starting at its flush boundary
+        // the item is only added or changed once its block is inflated, so a corrupt block leaves it as it was
+
+        PodData values;
+        values.count = entry.count;
+        values.type = entry.type;
+        values.filter = entry.filter;
+
+        result = read_block_at<reverse_bytes>(file, header, entry.offset, indexOffset, entry.size, entry.check32, buffer, key, values);
+
+        if (result != POD_SUCCESS)
+        {
+            return result;
+        }
+
+        if (key != entry.key)
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        auto& data = map[entry.key];
+        data.release();
+        data.values = std::move(values.values);
+        data.count = values.count;
+        data.type = values.type;
+        data.filter = values.filter;
+    }
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_load_items(pod_container_t* container, const char* fileName, pod_checksum_t checksum, uint32_t checksumValue, const char* const* keys, uint32_t keyCount)
+{
+    if ((container == nullptr) || (keys == nullptr && keyCount != 0))
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    PodHeader header;
+
+    {
+        File file(fileName, FM_READ);
+
+        if (!file.is_open())
+        {
+            return POD_FILE_NOT_FOUND;
+        }
+
+        uint32_t headerChecksumValue = checksumValue;
+
+        pod_result_t result = read_header(file, header, checksum, headerChecksumValue);
+
+        if (result != POD_SUCCESS)
+        {
+            return result;
+        }
+
+        // Seek directly to the requested blocks
+
+        if ((header.flags & POD_FLAGS_INDEX) != 0)
+        {
+            return catch_alloc([&]()
+            {
+                if (requires_byte_swap(header.endian))
+                {
+                    return readItems<true>(container, file, header, keys, keyCount);
+                }
+                else
+                {
+                    return readItems<false>(container, file, header, keys, keyCount);
+                }
+            });
+        }
+    }
+
+    // Without an index the whole file is inflated
+
+    pod_container_t tmp;
+
+    pod_result_t result = pod_load_file(&tmp, fileName, checksum, checksumValue);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    for (uint32_t i = 0; i != keyCount; ++i)
+    {
+        if (keys[i] == nullptr)
+        {
+            return POD_NULL_REFERENCE;
+        }
+
+        PodItem* item = tmp.map.find(keys[i]);
+
+        if (item != nullptr)
+        {
+            container->map[item->key] = std::move(item->data);
+            tmp.map.erase(*item);
+        }
+    }
+
+    return POD_SUCCESS;
+}
@@ -4,6 +4,8 @@
 #ifndef POD_LOOKUP_H
 #define POD_LOOKUP_H
 
+#include "pod_io.h"
+
 #include <limits>
 
 constexpr uint8_t cPODX[4] =
@@ -24,17 +26,52 @@ constexpr uint8_t cAD32[4] =
 constexpr uint8_t cCR32[4] =
     { 0x43u, 0x52u, 0x33u, 0x32u };
 
-constexpr uint32_t MaxCountLookup[] =
+constexpr uint8_t cC32C[4] =
+    { 0x43u, 0x33u, 0x32u, 0x43u };
+
+constexpr uint8_t cDEFL[4] =
+    { 0x44u, 0x45u, 0x46u, 0x4Cu };
+
+constexpr uint8_t cSTOR[4] =
+    { 0x53u, 0x54u, 0x4Fu, 0x52u };
+
+constexpr uint8_t cLZ01[4] =
+    { 0x4Cu, 0x5Au, 0x30u, 0x31u };
+
+constexpr uint32_t cFlagsMask =
+    POD_FLAGS_INDEX |
+    POD_FLAGS_FILTER |
+    POD_FLAGS_APPEND |
+    POD_FLAGS_COUNT64 |
+    POD_FLAGS_ALIGN |
+    POD_FLAGS_BLOCK_CHECKSUM;
+
+// Alignment of the header, blocks, and values of files saved with POD_FLAGS_ALIGN
+constexpr size_t cBlockAlignment =
+    64u;
+
+constexpr uint32_t cFilterShuffleMask =
+    0x000000FFu;
+
+constexpr uint32_t cFilterTransformMask =
+    0x0000FF00u;
+
+// Largest value count of a block in a file without POD_FLAGS_COUNT64
+constexpr uint64_t cMaxCount32 =
+    std::numeric_limits<uint32_t>::max();
+
+// Largest value count of an array that can be addressed in memory, indexed by the size of its type
+constexpr size_t MaxCountLookup[] =
     {
         0u,
-        std::numeric_limits<uint32_t>::max() / 1u, // 1 byte
-        std::numeric_limits<uint32_t>::max() / 2u, // 2 bytes
+        std::numeric_limits<size_t>::max() / 1u, // 1 byte
+        std::numeric_limits<size_t>::max() / 2u, // 2 bytes
         0u,
-        std::numeric_limits<uint32_t>::max() / 4u, // 4 bytes
+        std::numeric_limits<size_t>::max() / 4u, // 4 bytes
         0u,
         0u,
         0u,
-        std::numeric_limits<uint32_t>::max() / 8u, // 8 bytes
+        std::numeric_limits<size_t>::max() / 8u, // 8 bytes
     };
 
 #endif
@@ -0,0 +1,457 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodLz.h"
+#include "PodCodec.h"
+#include "PodLookup.h"
+
+#include <algorithm>
+#include <cstring>
+
+constexpr size_t cLzMinMatch = 4;
+constexpr size_t cLzMaxOffset = 65535;
+constexpr size_t cLzHashBits = 14;
+constexpr uint32_t cLzStoredFrame = 0x80000000u;
+
+static uint32_t read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static uint32_t lz_hash(uint32_t value)
+{
+    return (value * 2654435761u) >> (32 - cLzHashBits);
+}
+
+// Write a length that didn't fit in a token
+static uint8_t* write_length(uint8_t* op, size_t length)
+{
+    for (; length >= 255; length -= 255)
+    {
+        *op++ = 255;
+    }
+
+    *op++ = static_cast<uint8_t>(length);
+
+    return op;
+}
+
+// Read a length that didn't fit in a token, and add it to length
+static bool read_length(const uint8_t*& ip, const uint8_t* end, size_t& length)
+{
+    uint8_t value;
+
+    do
+    {
+        if (ip == end)
+        {
+            return false;
+        }
+
+        value = *ip++;
+        length += value;
+    }
+    while (value == 255);
+
+    return true;
+}
+
+// Write a sequence of literals followed by a match
+// a match length of 0 ends the block
+static uint8_t* write_sequence(uint8_t* op, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+{
+    size_t matchCode = (matchLength != 0) ? matchLength - cLzMinMatch : 0;
+
+    *op++ = static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+
+    if (literalCount >= 15)
+    {
+        op = write_length(op, literalCount - 15);
+    }
+
+    memcpy(op, literals, literalCount);
+    op += literalCount;
+
+    if (matchLength != 0)
+    {
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+
+        if (matchCode >= 15)
+        {
+            op = write_length(op, matchCode - 15);
+        }
+    }
+
+    return op;
+}
+
+size_t lz_bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t lz_compress(const uint8_t* in, size_t size, uint8_t* out)
+{
+    uint32_t table[1u << cLzHashBits] = {};
+
+    uint8_t* op = out;
+    size_t anchor = 0;
+    size_t pos = 0;
+    size_t misses = 0;
+
+    while (pos + cLzMinMatch <= size)
+    {
+        uint32_t sequence = read32(in + pos);
+        uint32_t& entry = table[lz_hash(sequence)];
+
+        size_t candidate = entry;
+        entry = static_cast<uint32_t>(pos);
+
+        if ((candidate >= pos) || (pos - candidate > cLzMaxOffset) || (read32(in + candidate) != sequence))
+        {
+            // step faster through bytes that don't compress
+            pos += 1 + (misses++ >> 6);
+            continue;
+        }
+
+        // Extend the match
+
+        size_t length = cLzMinMatch;
+
+        while (pos + length + 8 <= size)
+        {
+            uint64_t a, b;
+            memcpy(&a, in + candidate + length, 8);
+            memcpy(&b, in + pos + length, 8);
+
+            if (a != b)
+            {
+                break;
+            }
+
+            length += 8;
+        }
+
+        while ((pos + length < size) && (in[candidate + length] == in[pos + length]))
+        {
+            ++length;
+        }
+
+        op = write_sequence(op, in + anchor, pos - anchor, pos - candidate, length);
+
+        pos += length;
+        anchor = pos;
+        misses = 0;
+    }
+
+    op = write_sequence(op, in + anchor, size - anchor, 0, 0);
+
+    return op - out;
+}
+
+bool lz_decompress(const uint8_t* in, size_t size, uint8_t* out, size_t out_size)
+{
+    const uint8_t* ip = in;
+    const uint8_t* end = in + size;
+    uint8_t* op = out;
+    uint8_t* outEnd = out + out_size;
+
+    while (true)
+    {
+        if (ip == end)
+        {
+            return false;
+        }
+
+        uint8_t token = *ip++;
+
+        // Literals
+
+        size_t literalCount = token >> 4;
+
+        if ((literalCount == 15) && !read_length(ip, end, literalCount))
+        {
+            return false;
+        }
+
+        if ((literalCount > static_cast<size_t>(end - ip)) || (literalCount > static_cast<size_t>(outEnd - op)))
+        {
+            return false;
+        }
+
+        memcpy(op, ip, literalCount);
+        op += literalCount;
+        ip += literalCount;
+
+        // the last sequence has no match
+        if (ip == end)
+        {
+            break;
+        }
+
+        // Match
+
+        if (end - ip < 2)
+        {
+            return false;
+        }
+
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+
+        size_t length = token & 15;
+
+        if ((length == 15) && !read_length(ip, end, length))
+        {
+            return false;
+        }
+
+        length += cLzMinMatch;
+
+        if ((offset == 0) || (offset > static_cast<size_t>(op - out)) || (length > static_cast<size_t>(outEnd - op)))
+        {
+            return false;
+        }
+
+        const uint8_t* match = op - offset;
+
+        if (offset >= length)
+        {
+            memcpy(op, match, length);
+            op += length;
+        }
+        else
+        {
+            // the match overlaps the bytes it writes
+            for (size_t i = 0; i != length; ++i)
+            {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return op == outEnd;
+}
+
+// Codec
+
+static void set_le32(uint8_t* dst, uint32_t value)
+{
+    dst[0] = static_cast<uint8_t>(value);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+    dst[2] = static_cast<uint8_t>(value >> 16);
+    dst[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static uint32_t get_le32(const uint8_t* src)
+{
+    return
+        static_cast<uint32_t>(src[0]) |
+        (static_cast<uint32_t>(src[1]) << 8) |
+        (static_cast<uint32_t>(src[2]) << 16) |
+        (static_cast<uint32_t>(src[3]) << 24);
+}
+
+// Compress and write the current frame
+static void write_frame(compress_stream& cs)
+{
+    auto& frame = cs.frame;
+    auto& packed = cs.packed;
+
+    packed.resize(8 + lz_bound(frame.size()));
+
+    size_t size = lz_compress(frame.data(), frame.size(), packed.data() + 8);
+    uint32_t sizeField = static_cast<uint32_t>(size);
+
+    // store frames that don't compress
+    if (size >= frame.size())
+    {
+        memcpy(packed.data() + 8, frame.data(), frame.size());
+        size = frame.size();
+        sizeField = static_cast<uint32_t>(size) | cLzStoredFrame;
+    }
+
+    set_le32(packed.data(), sizeField);
+    set_le32(packed.data() + 4, static_cast<uint32_t>(frame.size()));
+
+    stream_write(cs, packed.data(), 8 + size);
+
+    frame.clear();
+}
+
+static compress_result lz_deflate_init(compress_stream& cs, pod_compression_t)
+{
+    cs.frame.clear();
+    cs.frame.reserve(cLzFrameSize);
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result lz_deflate_next(compress_stream& cs, uint8_t* in, size_t in_size)
+{
+    auto& frame = cs.frame;
+
+    while (in_size != 0)
+    {
+        size_t size = std::min(in_size, cLzFrameSize - frame.size());
+
+        frame.insert(frame.end(), in, in + size);
+        in += size;
+        in_size -= size;
+
+        if (frame.size() == cLzFrameSize)
+        {
+            write_frame(cs);
+        }
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result lz_deflate_flush(compress_stream& cs)
+{
+    // frames don't reference each other, so ending the frame is enough
+
+    if (!cs.frame.empty())
+    {
+        write_frame(cs);
+    }
+
+    stream_flush_point(cs);
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result lz_deflate_end(compress_stream& cs)
+{
+    if (!cs.frame.empty())
+    {
+        write_frame(cs);
+    }
+
+    uint8_t end[8] = {};
+    stream_write(cs, end, 8);
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result lz_inflate_init(compress_stream& cs)
+{
+    cs.frame.clear();
+    cs.frame_pos = 0;
+
+    return COMPRESS_SUCCESS;
+}
+
+// Read and decompress the next frame
+static compress_result read_frame(compress_stream& cs)
+{
+    uint8_t header[8];
+
+    if (stream_read(cs, header, 8) != 8)
+    {
+        return COMPRESS_ERROR;
+    }
+
+    uint32_t sizeField = get_le32(header);
+    uint32_t frameSize = get_le32(header + 4);
+
+    bool stored = (sizeField & cLzStoredFrame) != 0;
+    size_t size = sizeField & ~cLzStoredFrame;
+
+    cs.frame_pos = 0;
+    cs.frame.clear();
+
+    if ((size == 0) && (frameSize == 0) && !stored)
+    {
+        cs.finished = true;
+        return COMPRESS_STREAM_END;
+    }
+
+    if ((frameSize == 0) || (frameSize > cLzFrameSize) || (size > lz_bound(frameSize)) || (stored && (size != frameSize)))
+    {
+        return COMPRESS_ERROR;
+    }
+
+    cs.frame.resize(frameSize);
+
+    if (stored)
+    {
+        return (stream_read(cs, cs.frame.data(), size) == size) ? COMPRESS_SUCCESS : COMPRESS_ERROR;
+    }
+
+    cs.packed.resize(size);
+
+    if (stream_read(cs, cs.packed.data(), size) != size)
+    {
+        return COMPRESS_ERROR;
+    }
+
+    if (!lz_decompress(cs.packed.data(), size, cs.frame.data(), frameSize))
+    {
+        return COMPRESS_ERROR;
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result lz_inflate_next(compress_stream& cs, uint8_t* out, size_t out_size)
+{
+    auto& zs = cs.zs;
+
+    zs.avail_out = out_size;
+    zs.next_out = out;
+
+    size_t remaining = out_size;
+
+    while (remaining != 0)
+    {
+        if (cs.frame_pos == cs.frame.size())
+        {
+            if (cs.finished)
+            {
+                return COMPRESS_STREAM_END;
+            }
+
+            compress_result r = read_frame(cs);
+
+            if (r != COMPRESS_SUCCESS)
+            {
+                return r;
+            }
+        }
+
+        size_t size = std::min(remaining, cs.frame.size() - cs.frame_pos);
+
+        memcpy(out, cs.frame.data() + cs.frame_pos, size);
+        cs.frame_pos += size;
+        out += size;
+        remaining -= size;
+
+        zs.next_out = out;
+        zs.avail_out = remaining;
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+static compress_result lz_inflate_end(compress_stream&)
+{
+    return COMPRESS_SUCCESS;
+}
+
+const codec_interface lz_codec =
+    {
+        .tag = cLZ01,
+        .max_ratio = 256,
+        .deflate_init = lz_deflate_init,
+        .deflate_next = lz_deflate_next,
+        .deflate_flush = lz_deflate_flush,
+        .deflate_end = lz_deflate_end,
+        .inflate_init = lz_inflate_init,
+        .inflate_next = lz_inflate_next,
+        .inflate_end = lz_inflate_end,
+    };
@@ -0,0 +1,40 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_LZ_H
+#define POD_LZ_H
+
+#include <cstddef>
+#include <cstdint>
+
+// A small LZ77 codec that favours speed over ratio
+// The stream is a sequence of frames of up to 64KB, and every frame is compressed on its own
+//    [4] compressed size (little endian), the top bit is set if the frame is stored
+//    [4] frame size (little endian)
+//    [?] compressed bytes
+// and it ends with a frame whose sizes are both 0
+//
+// Compressed bytes are a sequence of
+//    [1] token, the high 4 bits are the literal count and the low 4 bits are the match length - 4
+//    [?] literal count - 15 as a run of 255s and a final byte less than 255 (if the count is at least 15)
+//    [?] literals
+//    [2] match offset (little endian)
+//    [?] match length - 19 as a run of 255s and a final byte less than 255 (if the length is at least 19)
+// the last sequence only has literals
+
+// Number of bytes in a full frame
+constexpr size_t cLzFrameSize = 64 * 1024;
+
+// Returns the largest number of bytes that size bytes can be compressed to
+size_t lz_bound(size_t size);
+
+// Compress size bytes from in
+// out must hold lz_bound(size) bytes
+// returns the number of compressed bytes
+size_t lz_compress(const uint8_t* in, size_t size, uint8_t* out);
+
+// Decompress size bytes from in into exactly out_size bytes
+// returns false if the compressed bytes are corrupt
+bool lz_decompress(const uint8_t* in, size_t size, uint8_t* out, size_t out_size);
+
+#endif
@@ -0,0 +1,338 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodTypes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+// number of items in the first block, each block after it holds twice as many as the last
+static constexpr size_t cFirstBlockSize = 16;
+
+// smallest table, which is allocated by the first insert
+static constexpr size_t cMinSlotCount = 16;
+
+// bounds of the size of key arena chunks
+static constexpr size_t cMinKeyChunkSize = 1u << 12;
+static constexpr size_t cMaxKeyChunkSize = 1u << 20;
+
+// the table grows once it is more than 7/8 full
+static size_t max_load(size_t slotCount)
+{
+    return slotCount - slotCount / 8;
+}
+
+// number of items in the first blockCount blocks
+static size_t block_capacity(size_t blockCount)
+{
+    return cFirstBlockSize * ((size_t(1) << blockCount) - 1);
+}
+
+PodMap::PodMap(const PodMap& other)
+{
+    *this = other;
+}
+
+PodMap& PodMap::operator=(const PodMap& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    clear();
+    reserve(other.size());
+
+    for (const auto& item : other)
+    {
+        insert(item.key).data = item.data;
+    }
+
+    return *this;
+}
+
+PodItem* PodMap::find(std::string_view key, uint32_t hash) const
+{
+    if (m_size == 0)
+    {
+        return nullptr;
+    }
+
+    size_t mask = m_slots.size() - 1;
+
+    for (size_t i = hash & mask; m_slots[i].item != nullptr; i = (i + 1) & mask)
+    {
+        // the stored hash skips most key comparisons
+        if ((m_slots[i].hash == hash) && (m_slots[i].item->key == key))
+        {
+            return m_slots[i].item;
+        }
+    }
+
+    return nullptr;
+}
+
+PodItem& PodMap::insert(std::string_view key, uint32_t hash)
+{
+    // looking up an item that exists never grows the table
+
+    PodItem* found = find(key, hash);
+
+    if (found != nullptr)
+    {
+        return *found;
+    }
+
+    if (m_size + 1 > max_load(m_slots.size()))
+    {
+        rehash(std::max(cMinSlotCount, m_slots.size() * 2));
+    }
+
+    size_t mask = m_slots.size() - 1;
+    size_t i = hash & mask;
+
+    while (m_slots[i].item != nullptr)
+    {
+        i = (i + 1) & mask;
+    }
+
+    PodItem* item = allocateItem();
+
+    item->key = storeKey(key);
+    item->hash = hash;
+    item->used = true;
+    item->data.count = 0;
+    item->data.type = POD_UINT8;
+
+    // link it after the last item
+
+    item->prev = m_last;
+    item->next = nullptr;
+    (m_last != nullptr ? m_last->next : m_first) = item;
+    m_last = item;
+
+    m_slots[i] = { hash, item };
+    ++m_size;
+
+    return *item;
+}
+
+void PodMap::erase(PodItem& item)
+{
+    if (!item.used)
+    {
+        return;
+    }
+
+    size_t mask = m_slots.size() - 1;
+    size_t i = item.hash & mask;
+
+    while (m_slots[i].item != &item)
+    {
+        i = (i + 1) & mask;
+    }
+
+    // Shift later items of the probe sequence back, so lookups don't need tombstones
+
+    for (size_t j = (i + 1) & mask; m_slots[j].item != nullptr; j = (j + 1) & mask)
+    {
+        size_t home = m_slots[j].hash & mask;
+
+        // the item at j can move to i if i is between its home slot and j
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+    }
+
+    m_slots[i] = { 0, nullptr };
+    --m_size;
+
+    (item.prev != nullptr ? item.prev->next : m_first) = item.next;
+    (item.next != nullptr ? item.next->prev : m_last) = item.prev;
+
+    m_keyBytes -= item.key.size();
+    m_deadKeyBytes += item.key.size();
+
+    item.key = {};
+    item.data = PodData();
+    item.prev = nullptr;
+    item.next = nullptr;
+    item.hash = 0;
+    item.used = false;
+
+    m_free.push_back(&item);
+
+    if ((m_deadKeyBytes > cMinKeyChunkSize * 16) && (m_deadKeyBytes > m_keyBytes))
+    {
+        compactKeys();
+    }
+}
+
+void PodMap::erase(std::string_view key)
+{
+    PodItem* item = find(key);
+
+    if (item != nullptr)
+    {
+        erase(*item);
+    }
+}
+
+void PodMap::reserve(size_t count)
+{
+    // the largest table is the largest power of two slots that a vector can hold,
+    // so the doubling below can't overflow
+
+    size_t maxSlotCount = cMinSlotCount;
+
+    while (maxSlotCount <= m_slots.max_size() / 2)
+    {
+        maxSlotCount *= 2;
+    }
+
+    if (count > max_load(maxSlotCount))
+    {
+        throw std::length_error("PodMap::reserve");
+    }
+
+    size_t slotCount = std::max(cMinSlotCount, m_slots.size());
+
+    while (max_load(slotCount) < count)
+    {
+        slotCount *= 2;
+    }
+
+    if (slotCount != m_slots.size())
+    {
+        rehash(slotCount);
+    }
+
+    // allocate the blocks too, so the items are added without allocating
+
+    size_t unused = m_free.size() + (block_capacity(m_blocks.size()) - block_capacity(m_block) - m_blockUsed);
+
+    while (count > m_size + unused)
+    {
+        if ((cFirstBlockSize << m_blocks.size()) > (std::numeric_limits<size_t>::max() >> 1))
+        {
+            throw std::length_error("PodMap::reserve");
+        }
+
+        unused += cFirstBlockSize << m_blocks.size();
+        m_blocks.push_back(std::make_unique<PodItem[]>(cFirstBlockSize << m_blocks.size()));
+    }
+}
+
+void PodMap::clear()
+{
+    m_blocks.clear();
+    m_free.clear();
+    m_block = 0;
+    m_blockUsed = 0;
+    m_size = 0;
+    m_first = nullptr;
+    m_last = nullptr;
+    m_slots.clear();
+    m_keyChunks.clear();
+    m_keyChunkSize = 0;
+    m_keyChunkUsed = 0;
+    m_keyBytes = 0;
+    m_deadKeyBytes = 0;
+}
+
+uint32_t PodMap::hashOf(std::string_view key)
+{
+    uint64_t hash = std::hash<std::string_view>()(key);
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+PodItem* PodMap::allocateItem()
+{
+    if (!m_free.empty())
+    {
+        PodItem* free = m_free.back();
+        m_free.pop_back();
+        return free;
+    }
+
+    // blocks are filled in order, so items added one after another are next to each other
+
+    if ((m_block != m_blocks.size()) && (m_blockUsed == (cFirstBlockSize << m_block)))
+    {
+        ++m_block;
+        m_blockUsed = 0;
+    }
+
+    if (m_block == m_blocks.size())
+    {
+        m_blocks.push_back(std::make_unique<PodItem[]>(cFirstBlockSize << m_block));
+    }
+
+    return &m_blocks[m_block][m_blockUsed++];
+}
+
+std::string_view PodMap::storeKey(std::string_view key)
+{
+    m_keyBytes += key.size();
+
+    if (m_keyChunks.empty() || (m_keyChunkSize - m_keyChunkUsed < key.size()))
+    {
+        m_keyChunkSize = std::max(key.size(), std::clamp(m_keyChunkSize * 2, cMinKeyChunkSize, cMaxKeyChunkSize));
+        m_keyChunkUsed = 0;
+        m_keyChunks.push_back(std::make_unique<char[]>(m_keyChunkSize));
+    }
+
+    char* dst = m_keyChunks.back().get() + m_keyChunkUsed;
+    m_keyChunkUsed += key.size();
+
+    if (!key.empty())
+    {
+        memcpy(dst, key.data(), key.size());
+    }
+
+    return { dst, key.size() };
+}
+
+void PodMap::compactKeys()
+{
+    std::vector<std::unique_ptr<char[]>> chunks;
+    std::swap(chunks, m_keyChunks);
+
+    m_keyChunkSize = 0;
+    m_keyChunkUsed = 0;
+    m_keyBytes = 0;
+    m_deadKeyBytes = 0;
+
+    for (auto& used : *this)
+    {
+        used.key = storeKey(used.key);
+    }
+}
+
+void PodMap::rehash(size_t slotCount)
+{
+    std::vector<Slot> slots(slotCount, Slot { 0, nullptr });
+    size_t mask = slotCount - 1;
+
+    for (const auto& slot : m_slots)
+    {
+        if (slot.item != nullptr)
+        {
+            size_t i = slot.hash & mask;
+
+            while (slots[i].item != nullptr)
+            {
+                i = (i + 1) & mask;
+            }
+
+            slots[i] = slot;
+        }
+    }
+
+    m_slots = std::move(slots);
+}
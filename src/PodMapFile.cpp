@@ -0,0 +1,230 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+#include "PodBlock.h"
+#include "PodBytes.h"
+#include "PodTypes.h"
+#include "PodHeader.h"
+#include "PodChecksum.h"
+#include "PodConfig.h"
+#include "PodMappedFile.h"
+#include "PodFilter.h"
+#include "PodIndex.h"
+#include "PodThreadPool.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Point an item at the values of the block at pos, and move pos past the block
+// if expectedKey isn't null, then the block must have that key
+static pod_result_t mapBlock(pod_container_t* container, const std::shared_ptr<MappedFile>& mapping, uint64_t& pos, uint64_t bodyEnd, pod_flags_t flags, const std::string* expectedKey)
+{
+    const uint8_t* bytes = mapping->data();
+    size_t blockHeaderSize = block_header_size(flags);
+
+    if ((pos > bodyEnd) || (bodyEnd - pos < blockHeaderSize))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    std::vector<uint8_t> blockHeader(bytes + pos, bytes + pos + blockHeaderSize);
+
+    uint32_t strSize, filter;
+    uint64_t valueCount;
+    pod_type_t type;
+
+    if (!decode_block_header<false>(blockHeader, strSize, valueCount, type, filter, flags))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    pos += blockHeaderSize;
+
+    if (bodyEnd - pos < strSize)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    std::string key(reinterpret_cast<const char*>(bytes + pos), strSize);
+
+    if ((expectedKey != nullptr) && (key != *expectedKey))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    pos += strSize;
+
+    // aligned blocks pad the key and the values to cBlockAlignment
+
+    bool aligned = (flags & POD_FLAGS_ALIGN) != 0;
+    uint64_t keyPadding = aligned ? next_multiple_of(blockHeaderSize + strSize, cBlockAlignment) - blockHeaderSize - strSize : 0;
+
+    if (bodyEnd - pos < keyPadding)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    pos += keyPadding;
+
+    uint64_t valuesSize = valueCount * size_of_type(type);
+    uint64_t valuesPadding = aligned ? next_multiple_of(valuesSize, cBlockAlignment) - valuesSize : 0;
+
+    if ((bodyEnd - pos < valuesSize) || (bodyEnd - pos - valuesSize < valuesPadding))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    auto& data = container->map[key];
+    data.release();
+    data.values.clear();
+    data.count = valueCount;
+    data.type = type;
+    data.filter = filter;
+
+    // filtered values have to be copied to undo the filter
+    if (filter != POD_FILTER_NONE)
+    {
+        uint8_t* values = data.values.allocate(valuesSize);
+        remove_filter(filter, bytes + pos, values, valueCount, size_of_type(type));
+        remove_transform(filter, values, valueCount, size_of_type(type));
+    }
+    else
+    {
+        data.mapped = bytes + pos;
+        data.mapping = mapping;
+    }
+
+    pos += valuesSize + valuesPadding;
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_map_file(pod_container_t* container, const char* fileName, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    if (container == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    auto mapping = std::make_shared<MappedFile>(fileName);
+
+    if (!mapping->is_open())
+    {
+        return POD_FILE_NOT_FOUND;
+    }
+
+    const uint8_t* bytes = mapping->data();
+    uint64_t size = mapping->size();
+
+    // Read header
+
+    PodHeader header;
+    uint32_t check32 = checksumValue;
+
+    pod_result_t result = read_header(bytes, size, header, checksum, check32);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // Only stored values in the endianness of the host can be used in place
+
+    if ((header.codec != CODEC_STORE) || requires_byte_swap(header.endian))
+    {
+        mapping.reset();
+        return pod_load_file(container, fileName, checksum, checksumValue);
+    }
+
+    // Validate checksum
+
+    if (size < header.size + checksum_size(checksum))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    uint64_t end = size - checksum_size(checksum);
+
+    if (checksum != POD_CHECKSUM_NONE)
+    {
+        // the whole mapping is checksummed in spans across the threads
+
+        size_t threadCount = config_thread_count();
+        ThreadPool pool((threadCount > 1) ? threadCount : 0);
+
+        check32 = checksum_update_parallel(checksum, check32, bytes + header.size, static_cast<size_t>(end - header.size), pool);
+
+        uint32_t fileCheck32;
+        memcpy(&fileCheck32, bytes + end, 4);
+
+        if (fileCheck32 != check32)
+        {
+            return POD_FILE_CORRUPT;
+        }
+    }
+
+    // Stored blocks end at the index
+
+    uint64_t bodyEnd = end;
+
+    if ((header.flags & POD_FLAGS_INDEX) != 0)
+    {
+        if (end < header.size + 8)
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        memcpy(&bodyEnd, bytes + end - 8, 8);
+
+        if ((bodyEnd < header.size) || (bodyEnd > end - 8))
+        {
+            return POD_FILE_CORRUPT;
+        }
+    }
+
+    // Point every item at its values in the mapping
+
+    if ((header.flags & POD_FLAGS_APPEND) != 0)
+    {
+        // blocks of appended segments are found through the index of the last segment
+
+        std::vector<uint8_t> buffer(bytes + bodyEnd, bytes + end);
+        std::vector<PodIndexEntry> index;
+
+        if (!decode_index<false>(index, buffer, bodyEnd, header.flags))
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        for (const auto& entry : index)
+        {
+            uint64_t pos = entry.offset;
+
+            result = mapBlock(container, mapping, pos, bodyEnd, header.flags, &entry.key);
+
+            if (result != POD_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        return POD_SUCCESS;
+    }
+
+    uint64_t pos = header.size;
+
+    while (pos != bodyEnd)
+    {
+        result = mapBlock(container, mapping, pos, bodyEnd, header.flags, nullptr);
+
+        if (result != POD_SUCCESS)
+        {
+            return result;
+        }
+    }
+
+    return POD_SUCCESS;
+}
@@ -0,0 +1,149 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodMappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const char* filename)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_open(false)
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+{
+    m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(m_file, &size))
+    {
+        return;
+    }
+
+    m_size = static_cast<uint64_t>(size.QuadPart);
+    m_open = true;
+
+    // an empty file can't be mapped
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (m_mapping == nullptr)
+    {
+        m_open = false;
+        return;
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (m_data == nullptr)
+    {
+        m_open = false;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const char* filename)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_open(false)
+{
+    int fd = open(filename, O_RDONLY);
+
+    if (fd == -1)
+    {
+        return;
+    }
+
+    struct stat st {};
+
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return;
+    }
+
+    m_size = static_cast<uint64_t>(st.st_size);
+    m_open = true;
+
+    // an empty file can't be mapped
+    if (m_size != 0)
+    {
+        void* ptr = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (ptr == MAP_FAILED)
+        {
+            m_open = false;
+        }
+        else
+        {
+            m_data = static_cast<const uint8_t*>(ptr);
+        }
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+}
+
+#endif
+
+const uint8_t* MappedFile::data() const
+{
+    return m_data;
+}
+
+uint64_t MappedFile::size() const
+{
+    return m_size;
+}
+
+bool MappedFile::is_open() const
+{
+    return m_open;
+}
@@ -0,0 +1,46 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_MAPPED_FILE_H
+#define POD_MAPPED_FILE_H
+
+#include <cstdint>
+#include <cstddef>
+
+// A read-only memory mapping of an entire file
+class MappedFile
+{
+public:
+
+    explicit MappedFile(const char* filename);
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    // Returns a pointer to the first byte of the file
+    [[nodiscard]]
+    const uint8_t* data() const;
+
+    // Returns the size of the file in bytes
+    [[nodiscard]]
+    uint64_t size() const;
+
+    // Returns true if the file is mapped
+    [[nodiscard]]
+    bool is_open() const;
+
+protected:
+    const uint8_t* m_data;
+    uint64_t m_size;
+    bool m_open;
+
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
+
+#endif
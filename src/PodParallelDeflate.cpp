@@ -0,0 +1,309 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodParallelDeflate.h"
+#include "PodChecksum.h"
+#include "PodCodec.h"
+#include "PodThreadPool.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <memory>
+
+// Size of the uncompressed chunk given to each worker
+constexpr size_t cChunkSize = 128 * 1024;
+
+// Size of the DEFLATE window used as a preset dictionary
+constexpr size_t cDictionarySize = 32 * 1024;
+
+using chunk_ptr = std::shared_ptr<std::vector<uint8_t>>;
+
+struct deflate_job
+{
+    chunk_ptr in;              // uncompressed chunk
+    chunk_ptr dictionary;      // previous chunk, or null if the chunk starts a flush point
+    std::vector<uint8_t> out;  // compressed chunk
+    int level;                 // compression level
+    int flush;                 // Z_SYNC_FLUSH, or Z_FINISH for the last chunk
+    pod_checksum_t checksum;   // checksum type of the stream
+    uint32_t check32;          // checksum of the compressed chunk, starting from checksum_initial()
+    bool flushPoint;           // true if a flush point follows the chunk
+    bool ok;                   // true if the chunk was compressed
+    std::future<void> done;    // ready when the worker is finished
+};
+
+struct parallel_deflate
+{
+    explicit parallel_deflate(size_t threadCount)
+        : level(Z_DEFAULT_COMPRESSION)
+        , pool(threadCount)
+    {}
+
+    int level;                                      // compression level
+    chunk_ptr chunk;                                // chunk being filled
+    chunk_ptr previous;                             // last queued chunk, or null after a flush point
+    std::deque<std::unique_ptr<deflate_job>> jobs;  // queued chunks in stream order
+    ThreadPool pool;                                // workers (declared last, so they finish before the jobs are freed)
+};
+
+static void compress_job(deflate_job& job)
+{
+    z_stream zs =
+        {
+            .zalloc = Z_NULL,
+            .zfree = Z_NULL,
+            .opaque = Z_NULL
+        };
+
+    job.ok = false;
+
+    if (deflateInit2(&zs, job.level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return;
+    }
+
+    if (job.dictionary != nullptr)
+    {
+        size_t size = std::min(job.dictionary->size(), cDictionarySize);
+        const uint8_t* dictionary = job.dictionary->data() + job.dictionary->size() - size;
+
+        if (deflateSetDictionary(&zs, dictionary, size) != Z_OK)
+        {
+            deflateEnd(&zs);
+            return;
+        }
+    }
+
+    auto& in = *job.in;
+    auto& out = job.out;
+
+    // room for the sync flush marker and the final block
+    out.resize(deflateBound(&zs, in.size()) + 16);
+
+    zs.next_in = in.data();
+    zs.avail_in = in.size();
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+
+    while (true)
+    {
+        int r = deflate(&zs, job.flush);
+
+        if (r == Z_STREAM_END)
+        {
+            break;
+        }
+
+        if (r != Z_OK && r != Z_BUF_ERROR)
+        {
+            deflateEnd(&zs);
+            return;
+        }
+
+        // a sync flush is complete once deflate() leaves output space
+        if (job.flush != Z_FINISH && zs.avail_out != 0)
+        {
+            break;
+        }
+
+        size_t produced = out.size() - zs.avail_out;
+        out.resize(out.size() * 2);
+        zs.next_out = out.data() + produced;
+        zs.avail_out = out.size() - produced;
+    }
+
+    out.resize(out.size() - zs.avail_out);
+
+    // deflateEnd() reports Z_DATA_ERROR for a stream that ends with a sync flush
+    deflateEnd(&zs);
+
+    // the chunk is checksummed here too, and combined in stream order when it is written
+    job.check32 = checksum_update(job.checksum, checksum_initial(job.checksum), out.data(), out.size());
+
+    job.ok = true;
+}
+
+// Wait for the oldest chunk and write it to the file
+static compress_result write_job(compress_stream& cs)
+{
+    auto& pd = *cs.parallel;
+    auto job = std::move(pd.jobs.front());
+    pd.jobs.pop_front();
+
+    try
+    {
+        job->done.get();
+    }
+    catch (...)
+    {
+        return COMPRESS_ERROR;
+    }
+
+    if (!job->ok)
+    {
+        return COMPRESS_ERROR;
+    }
+
+    stream_write_checked(cs, job->out.data(), job->out.size(), job->check32);
+
+    if (job->flushPoint)
+    {
+        stream_flush_point(cs);
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+// Queue the current chunk
+static compress_result submit_chunk(compress_stream& cs, int flush, bool flushPoint)
+{
+    auto& pd = *cs.parallel;
+
+    auto job = std::make_unique<deflate_job>();
+    job->in = std::move(pd.chunk);
+    job->dictionary = pd.previous;
+    job->level = pd.level;
+    job->flush = flush;
+    job->checksum = cs.checksum;
+    job->flushPoint = flushPoint;
+    job->ok = false;
+
+    pd.previous = flushPoint ? nullptr : job->in;
+
+    auto ptr = job.get();
+    job->done = pd.pool.submit([ptr]{ compress_job(*ptr); });
+    pd.jobs.push_back(std::move(job));
+
+    pd.chunk = std::make_shared<std::vector<uint8_t>>();
+    pd.chunk->reserve(cChunkSize);
+
+    // limit the number of chunks held in memory
+    while (pd.jobs.size() > 2 * pd.pool.size())
+    {
+        if (write_job(cs) != COMPRESS_SUCCESS)
+        {
+            return COMPRESS_ERROR;
+        }
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+compress_result parallel_deflate_init(compress_stream& cs, pod_compression_t compression, size_t threadCount)
+{
+    cs.parallel = std::make_shared<parallel_deflate>(threadCount);
+
+    auto& pd = *cs.parallel;
+    pd.level = static_cast<int>(compression);
+    pd.chunk = std::make_shared<std::vector<uint8_t>>();
+    pd.chunk->reserve(cChunkSize);
+
+    return COMPRESS_SUCCESS;
+}
+
+compress_result parallel_deflate_next(compress_stream& cs, const uint8_t* in, size_t in_size)
+{
+    auto& pd = *cs.parallel;
+
+    while (in_size != 0)
+    {
+        auto& chunk = *pd.chunk;
+
+        size_t size = std::min(in_size, cChunkSize - chunk.size());
+        chunk.insert(chunk.end(), in, in + size);
+
+        in += size;
+        in_size -= size;
+
+        if (chunk.size() == cChunkSize)
+        {
+            if (submit_chunk(cs, Z_SYNC_FLUSH, false) != COMPRESS_SUCCESS)
+            {
+                return COMPRESS_ERROR;
+            }
+        }
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+compress_result parallel_deflate_flush(compress_stream& cs)
+{
+    auto& pd = *cs.parallel;
+
+    if (!pd.chunk->empty())
+    {
+        return submit_chunk(cs, Z_SYNC_FLUSH, true);
+    }
+
+    // the flush point follows the last queued chunk
+    if (!pd.jobs.empty())
+    {
+        pd.jobs.back()->flushPoint = true;
+    }
+    else
+    {
+        stream_flush_point(cs);
+    }
+
+    pd.previous = nullptr;
+
+    return COMPRESS_SUCCESS;
+}
+
+compress_result parallel_deflate_copy_block(compress_stream& cs, const uint8_t* block, size_t size)
+{
+    auto& pd = *cs.parallel;
+
+    if (!pd.chunk->empty())
+    {
+        return COMPRESS_ERROR;
+    }
+
+    // the block is written in stream order by a job that only checksums it
+
+    auto job = std::make_unique<deflate_job>();
+    job->out.assign(block, block + size);
+    job->checksum = cs.checksum;
+    job->flushPoint = true;
+    job->ok = true;
+
+    auto ptr = job.get();
+    job->done = pd.pool.submit([ptr]{ ptr->check32 = checksum_update(ptr->checksum, checksum_initial(ptr->checksum), ptr->out.data(), ptr->out.size()); });
+    pd.jobs.push_back(std::move(job));
+
+    pd.previous = nullptr;
+
+    while (pd.jobs.size() > 2 * pd.pool.size())
+    {
+        if (write_job(cs) != COMPRESS_SUCCESS)
+        {
+            return COMPRESS_ERROR;
+        }
+    }
+
+    return COMPRESS_SUCCESS;
+}
+
+compress_result parallel_deflate_end(compress_stream& cs)
+{
+    auto& pd = *cs.parallel;
+
+    if (submit_chunk(cs, Z_FINISH, false) != COMPRESS_SUCCESS)
+    {
+        return COMPRESS_ERROR;
+    }
+
+    while (!pd.jobs.empty())
+    {
+        if (write_job(cs) != COMPRESS_SUCCESS)
+        {
+            return COMPRESS_ERROR;
+        }
+    }
+
+    cs.parallel.reset();
+
+    return COMPRESS_SUCCESS;
+}
@@ -0,0 +1,32 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_PARALLEL_DEFLATE_H
+#define POD_PARALLEL_DEFLATE_H
+
+#include "PodDeflate.h"
+
+// Deflates a stream on worker threads
+// The input is split into chunks that are compressed independently, with the end
+// of the previous chunk as a preset dictionary, and ended with a sync flush so that
+// the output of every chunk can be concatenated into one raw DEFLATE stream.
+struct parallel_deflate;
+
+// Initialize a parallel deflate stream for cs
+// returns COMPRESS_SUCCESS on success
+// and COMPRESS_ERROR on failure
+compress_result parallel_deflate_init(compress_stream& cs, pod_compression_t compression, size_t threadCount);
+
+// Queue input to be deflated
+compress_result parallel_deflate_next(compress_stream& cs, const uint8_t* in, size_t in_size);
+
+// End the current chunk and start the next one without a dictionary
+compress_result parallel_deflate_flush(compress_stream& cs);
+
+// Queue a block that was already deflated, at a flush point
+compress_result parallel_deflate_copy_block(compress_stream& cs, const uint8_t* block, size_t size);
+
+// Finish the stream and write every remaining chunk
+compress_result parallel_deflate_end(compress_stream& cs);
+
+#endif
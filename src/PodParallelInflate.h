@@ -0,0 +1,396 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_PARALLEL_INFLATE_H
+#define POD_PARALLEL_INFLATE_H
+
+#include "pod_io.h"
+#include "PodBlock.h"
+#include "PodChecksum.h"
+#include "PodDeflate.h"
+#include "PodFile.h"
+#include "PodHeader.h"
+#include "PodIndex.h"
+#include "PodThreadPool.h"
+#include "PodTypes.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A block that is inflated on a worker thread
+struct inflate_job
+{
+    std::vector<uint8_t> in;         // compressed bytes of the block
+    const PodIndexEntry* entry;      // index entry of the block
+    PodData values;                  // count, type, filter, and values inflated from the block
+    PodData* data;                   // item that the values are moved to once the job succeeds
+    pod_result_t result;             // result of inflating the block
+    uint32_t check32;                // checksum of in, starting from checksum_initial()
+    std::future<void> done;          // ready once the block has been inflated
+};
+
+// Inflate the block of a job and check it against its index entry
+// blocks of files with POD_FLAGS_BLOCK_CHECKSUM are checked against their checksum first
+// the bytes of the job are also checksummed, so that the file checksum can be combined from every job
+template<bool reverse_bytes>
+void inflate_job_run(inflate_job& job, const PodHeader& header)
+{
+    uint64_t size = job.in.size();
+    uint32_t initial = checksum_initial(header.checksum);
+
+    if ((header.flags & POD_FLAGS_BLOCK_CHECKSUM) != 0)
+    {
+        // the block checksum covers the start of the bytes, up to any replaced blocks that follow it
+
+        size = std::min<uint64_t>(job.entry->size, job.in.size());
+
+        uint32_t blockCheck32 = checksum_update(header.checksum, initial, job.in.data(), size);
+        uint32_t restCheck32 = checksum_update(header.checksum, initial, job.in.data() + size, job.in.size() - size);
+
+        job.check32 = checksum_combine(header.checksum, blockCheck32, restCheck32, job.in.size() - size);
+
+        if ((size != job.entry->size) || (blockCheck32 != job.entry->check32))
+        {
+            job.result = POD_FILE_CORRUPT;
+            return;
+        }
+    }
+    else
+    {
+        job.check32 = checksum_update(header.checksum, initial, job.in.data(), size);
+    }
+
+    auto is = std::make_unique<compress_stream>();
+
+    if (inflate_init_buffer(*is, job.in.data(), header.codec, size) != COMPRESS_SUCCESS)
+    {
+        job.result = POD_ZLIB_ERROR;
+        return;
+    }
+
+    std::vector<uint8_t> buffer;
+    std::string key;
+    uint64_t valueCount;
+    uint32_t filter;
+    pod_type_t type;
+
+    compress_result r = inflate_block_header<reverse_bytes>(*is, buffer, key, valueCount, type, filter, header.flags);
+
+    if ((r != COMPRESS_SUCCESS) || (key != job.entry->key) || (valueCount != job.entry->count) || (type != job.entry->type) || (filter != job.entry->filter))
+    {
+        inflate_end(*is);
+        job.result = POD_FILE_CORRUPT;
+        return;
+    }
+
+    r = inflate_block_values<reverse_bytes>(*is, buffer, job.values, header.flags);
+
+    if ((inflate_end(*is) != COMPRESS_SUCCESS) || (r == COMPRESS_ERROR))
+    {
+        job.result = POD_FILE_CORRUPT;
+        return;
+    }
+
+    job.result = POD_SUCCESS;
+}
+
+// Wait for a job to finish
+// returns the result of the job
+inline pod_result_t inflate_job_wait(inflate_job& job)
+{
+    try
+    {
+        job.done.get();
+    }
+    catch (...)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    return job.result;
+}
+
+// Read the body of an indexed file, inflating its blocks on threadCount worker threads
+// Files saved with POD_FLAGS_APPEND are always read this way, since only the index finds their blocks.
+// Blocks are read in file order on the calling thread, then checksummed, inflated, byte swapped,
+// and stored in the container by the workers, and the checksum of each block is combined into the file checksum.
+// Files saved with POD_FLAGS_BLOCK_CHECKSUM are also always read this way, and the workers check
+// every block against its own checksum as well.
+// Items only get their values once their block is inflated, so after a failure every item is either
+// fully loaded, as it was before the load, or removed if the load added it.
+// If corrupt isn't null, then items with a corrupt block are left as they were before the load
+// (or removed if the load added them) and their keys are added to corrupt, instead of stopping at the first one.
+template<bool reverse_bytes>
+pod_result_t readBytesParallel(pod_container_t* container, File& file, const PodHeader& header, uint32_t check32, size_t threadCount, std::vector<std::string>* corrupt = nullptr)
+{
+    // Read index and trailer
+
+    uint64_t indexOffset;
+
+    if (!read_index_offset<reverse_bytes>(file, header, indexOffset))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    size_t trailerSize = file.size() - indexOffset;
+    size_t indexSize = trailerSize - checksum_size(header.checksum);
+
+    std::vector<uint8_t> trailer(trailerSize);
+
+    if (!file.seek(indexOffset) || (file.read(trailer.data(), trailerSize) != trailerSize))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // the index is padded to 8 bytes, so a truncated file can't be aligned
+    if ((indexSize % 8) != 0)
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    uint32_t fileCheck32 = 0;
+
+    if (header.checksum != POD_CHECKSUM_NONE)
+    {
+        get_bytes<uint32_t, reverse_bytes>(fileCheck32, trailer, indexSize, 4);
+    }
+
+    trailer.resize(indexSize);
+
+    std::vector<PodIndexEntry> index;
+
+    if (!decode_index<reverse_bytes>(index, trailer, indexOffset, header.flags))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Blocks are read in file order
+    // files with appended segments can hold replaced blocks and indexes between them
+
+    std::vector<size_t> order(index.size());
+
+    for (size_t i = 0; i != index.size(); ++i)
+    {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [&index](size_t a, size_t b){ return index[a].offset < index[b].offset; });
+
+    for (size_t i = 0; i != order.size(); ++i)
+    {
+        bool ordered = (i == 0) ? (index[order[i]].offset >= header.size) : (index[order[i]].offset > index[order[i - 1]].offset);
+
+        if (!ordered)
+        {
+            return POD_FILE_CORRUPT;
+        }
+    }
+
+    // every key must be unique
+
+    std::vector<const std::string*> keys(index.size());
+
+    for (size_t i = 0; i != index.size(); ++i)
+    {
+        keys[i] = &index[i].key;
+    }
+
+    std::sort(keys.begin(), keys.end(), [](const std::string* a, const std::string* b){ return *a < *b; });
+
+    if (std::adjacent_find(keys.begin(), keys.end(), [](const std::string* a, const std::string* b){ return *a == *b; }) != keys.end())
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Add items before starting the workers, so the container isn't modified while they run
+    // items keep their current values until their block is inflated
+
+    auto& map = container->map;
+    std::vector<PodItem*> items(index.size());
+    std::vector<bool> added(index.size());
+    std::vector<bool> loaded(index.size(), false);
+
+    for (size_t i = 0; i != index.size(); ++i)
+    {
+        added[i] = (map.find(index[i].key) == nullptr);
+        items[i] = &map.insert(index[i].key);
+    }
+
+    // After a failure, items that the load added and didn't finish are removed
+
+    auto discard = [&]()
+    {
+        for (size_t i = 0; i != items.size(); ++i)
+        {
+            if (added[i] && !loaded[i])
+            {
+                map.erase(*items[i]);
+            }
+        }
+    };
+
+    // Read blocks and queue them to be inflated
+
+    if (!file.seek(header.size))
+    {
+        discard();
+        return POD_FILE_CORRUPT;
+    }
+
+    pod_result_t result = POD_SUCCESS;
+
+    std::deque<std::unique_ptr<inflate_job>> jobs;
+    ThreadPool pool(threadCount);  // declared after jobs, so the workers finish before the jobs are freed
+
+    // Keys of corrupt blocks are kept when salvaging, and reported once the workers are done
+
+    std::vector<std::string> salvaged;
+
+    auto finish = [&](inflate_job& job)
+    {
+        pod_result_t r = inflate_job_wait(job);
+
+        // jobs finish in file order
+
+        check32 = checksum_combine(header.checksum, check32, job.check32, job.in.size());
+
+        if (r == POD_SUCCESS)
+        {
+            auto& data = *job.data;
+            data.release();
+            data.values = std::move(job.values.values);
+            data.count = job.values.count;
+            data.type = job.values.type;
+            data.filter = job.values.filter;
+
+            loaded[job.entry - index.data()] = true;
+        }
+
+        if ((r == POD_FILE_CORRUPT) && (corrupt != nullptr))
+        {
+            salvaged.push_back(job.entry->key);
+            return POD_SUCCESS;
+        }
+
+        return r;
+    };
+
+    // Bytes that aren't part of a block are only checksummed
+
+    std::vector<uint8_t> skipped;
+
+    auto skip = [&](uint64_t end)
+    {
+        uint64_t remaining = end - file.tell();
+
+        skipped.resize(static_cast<size_t>(std::min<uint64_t>(remaining, 1u << 16)));
+
+        while (remaining != 0)
+        {
+            size_t size = static_cast<size_t>(std::min<uint64_t>(remaining, skipped.size()));
+
+            if (file.read(skipped.data(), size) != size)
+            {
+                return false;
+            }
+
+            check32 = checksum_update(header.checksum, check32, skipped.data(), size);
+            remaining -= size;
+        }
+
+        return true;
+    };
+
+    if (!skip(index.empty() ? indexOffset : index[order[0]].offset))
+    {
+        discard();
+        return POD_FILE_CORRUPT;
+    }
+
+    for (size_t j = 0; j != order.size(); ++j)
+    {
+        size_t i = order[j];
+
+        // the block ends where the next one starts
+        uint64_t blockEnd = (j + 1 != order.size()) ? index[order[j + 1]].offset : indexOffset;
+
+        auto job = std::make_unique<inflate_job>();
+        job->in.resize(blockEnd - index[i].offset);
+        job->entry = &index[i];
+        job->values.count = index[i].count;
+        job->values.type = index[i].type;
+        job->values.filter = index[i].filter;
+        job->data = &items[i]->data;
+
+        if (file.read(job->in.data(), job->in.size()) != job->in.size())
+        {
+            result = POD_FILE_CORRUPT;
+            break;
+        }
+
+        auto ptr = job.get();
+        auto headerPtr = &header;
+        job->done = pool.submit([ptr, headerPtr](){ inflate_job_run<reverse_bytes>(*ptr, *headerPtr); });
+        jobs.push_back(std::move(job));
+
+        // Limit the number of compressed blocks held in memory
+
+        if (jobs.size() >= 2 * pool.size())
+        {
+            result = finish(*jobs.front());
+            jobs.pop_front();
+
+            if (result != POD_SUCCESS)
+            {
+                break;
+            }
+        }
+    }
+
+    while (!jobs.empty())
+    {
+        pod_result_t r = finish(*jobs.front());
+        jobs.pop_front();
+
+        if (result == POD_SUCCESS)
+        {
+            result = r;
+        }
+    }
+
+    if (result != POD_SUCCESS)
+    {
+        discard();
+        return result;
+    }
+
+    // only corrupt blocks are left unfinished
+    discard();
+
+    if (corrupt != nullptr)
+    {
+        corrupt->insert(corrupt->end(), salvaged.begin(), salvaged.end());
+    }
+
+    if (!salvaged.empty())
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Validate checksum
+
+    check32 = checksum_update(header.checksum, check32, trailer.data(), indexSize);
+
+    if ((header.checksum != POD_CHECKSUM_NONE) && (fileCheck32 != check32))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    return POD_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,316 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodPipeline.h"
+#include "PodChecksum.h"
+
+#include <algorithm>
+
+ReadAhead::ReadAhead(File& file, uint64_t size, size_t chunkSize, pod_checksum_t checksum)
+    : m_file(file)
+    , m_checksum(checksum)
+    , m_start(file.tell())
+    , m_remaining(size)
+    , m_returned(0)
+    , m_chunkSize(chunkSize)
+    , m_counts{0, 0}
+    , m_checks{0, 0}
+    , m_releasedCheck32(checksum_initial(checksum))
+    , m_released(0)
+    , m_filled(0)
+    , m_readIndex(0)
+    , m_nextIndex(0)
+    , m_held(false)
+    , m_done(false)
+    , m_stop(false)
+    , m_stopped(false)
+{
+    m_file.advise_sequential();
+
+    m_thread = std::thread(&ReadAhead::run, this);
+}
+
+ReadAhead::~ReadAhead()
+{
+    stop();
+}
+
+const uint8_t* ReadAhead::next(size_t& count)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Release the last chunk, so the thread can read into it
+
+    if (m_held)
+    {
+        size_t held = m_nextIndex ^ 1;
+
+        m_releasedCheck32 = checksum_combine(m_checksum, m_releasedCheck32, m_checks[held], m_counts[held]);
+        m_released += m_counts[held];
+
+        m_held = false;
+        --m_filled;
+        m_cv.notify_all();
+    }
+
+    m_cv.wait(lock, [this](){ return (m_filled != 0) || m_done; });
+
+    if (m_filled == 0)
+    {
+        count = 0;
+        return nullptr;
+    }
+
+    size_t index = m_nextIndex;
+    m_nextIndex ^= 1;
+    m_held = true;
+
+    count = m_counts[index];
+    m_returned += count;
+
+    return m_chunks[index].data();
+}
+
+void ReadAhead::stop()
+{
+    if (m_stopped)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cv.notify_all();
+    m_thread.join();
+
+    m_file.seek(m_start + m_returned);
+    m_stopped = true;
+}
+
+uint32_t ReadAhead::checksum(uint32_t check32, size_t unused) const
+{
+    check32 = checksum_combine(m_checksum, check32, m_releasedCheck32, m_released);
+
+    if (!m_held)
+    {
+        return check32;
+    }
+
+    // only part of the last chunk may have been used
+
+    size_t held = m_nextIndex ^ 1;
+    size_t used = m_counts[held] - std::min(unused, m_counts[held]);
+
+    if (used == m_counts[held])
+    {
+        return checksum_combine(m_checksum, check32, m_checks[held], used);
+    }
+
+    return checksum_update(m_checksum, check32, m_chunks[held].data(), used);
+}
+
+void ReadAhead::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_cv.wait(lock, [this](){ return m_stop || (m_filled < 2); });
+
+        if (m_stop || (m_remaining == 0))
+        {
+            break;
+        }
+
+        // the chunk isn't held by the caller, so it is read without the lock
+
+        size_t index = m_readIndex;
+        size_t size = static_cast<size_t>(std::min<uint64_t>(m_remaining, m_chunkSize));
+
+        lock.unlock();
+
+        m_chunks[index].resize(size);
+        size_t count = m_file.read(m_chunks[index].data(), size);
+        uint32_t check32 = checksum_update(m_checksum, checksum_initial(m_checksum), m_chunks[index].data(), count);
+
+        lock.lock();
+
+        m_counts[index] = count;
+        m_checks[index] = check32;
+        m_readIndex ^= 1;
+        ++m_filled;
+
+        // a short read ends the range
+        m_remaining = (count == size) ? m_remaining - size : 0;
+
+        m_cv.notify_all();
+    }
+
+    m_done = true;
+    m_cv.notify_all();
+}
+
+WriteBehind::WriteBehind(File& file, size_t chunkSize, pod_checksum_t checksum, uint32_t check32)
+    : m_file(file)
+    , m_chunkSize(chunkSize)
+    , m_checksum(checksum)
+    , m_check32(check32)
+    , m_markCheck32(checksum_initial(checksum))
+    , m_current(0)
+    , m_pending(false)
+    , m_stop(false)
+{
+    m_chunks[0].reserve(chunkSize);
+}
+
+WriteBehind::~WriteBehind()
+{
+    finish();
+}
+
+void WriteBehind::write(const uint8_t* data, size_t size)
+{
+    while (size != 0)
+    {
+        auto& chunk = m_chunks[m_current];
+        size_t ds = std::min(size, m_chunkSize - chunk.size());
+
+        chunk.insert(chunk.end(), data, data + ds);
+        data += ds;
+        size -= ds;
+
+        if (chunk.size() == m_chunkSize)
+        {
+            submit();
+        }
+    }
+}
+
+void WriteBehind::finish()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    // the last chunk isn't full, so it is written on the calling thread
+
+    write_chunk(m_current);
+}
+
+void WriteBehind::mark()
+{
+    m_marks[m_current].push_back(m_chunks[m_current].size());
+}
+
+bool WriteBehind::checksummed() const
+{
+    return m_checksum != POD_CHECKSUM_NONE;
+}
+
+uint32_t WriteBehind::check32() const
+{
+    return m_check32;
+}
+
+const std::vector<uint32_t>& WriteBehind::mark_checks() const
+{
+    return m_markChecks;
+}
+
+void WriteBehind::write_chunk(size_t index)
+{
+    auto& chunk = m_chunks[index];
+    auto& marks = m_marks[index];
+
+    if (!chunk.empty())
+    {
+        m_file.write(chunk.data(), chunk.size());
+    }
+
+    // each span between marks is checksummed once, and combined into both checksums
+
+    if (m_checksum != POD_CHECKSUM_NONE)
+    {
+        size_t pos = 0;
+
+        for (size_t i = 0; i <= marks.size(); ++i)
+        {
+            size_t end = (i != marks.size()) ? marks[i] : chunk.size();
+            uint32_t span = checksum_update(m_checksum, checksum_initial(m_checksum), chunk.data() + pos, end - pos);
+
+            m_check32 = checksum_combine(m_checksum, m_check32, span, end - pos);
+            m_markCheck32 = checksum_combine(m_checksum, m_markCheck32, span, end - pos);
+
+            if (i != marks.size())
+            {
+                m_markChecks.push_back(m_markCheck32);
+                m_markCheck32 = checksum_initial(m_checksum);
+            }
+
+            pos = end;
+        }
+    }
+
+    chunk.clear();
+    marks.clear();
+}
+
+void WriteBehind::submit()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // wait for the thread to finish the other chunk
+    m_cv.wait(lock, [this](){ return !m_pending; });
+
+    m_pending = true;
+    m_current ^= 1;
+    m_chunks[m_current].clear();
+    m_chunks[m_current].reserve(m_chunkSize);
+    m_marks[m_current].clear();
+
+    lock.unlock();
+
+    if (!m_thread.joinable())
+    {
+        m_thread = std::thread(&WriteBehind::run, this);
+    }
+    else
+    {
+        m_cv.notify_all();
+    }
+}
+
+void WriteBehind::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_cv.wait(lock, [this](){ return m_stop || m_pending; });
+
+        if (!m_pending)
+        {
+            break;
+        }
+
+        // the pending chunk is the one that write() isn't copying to
+        size_t index = m_current ^ 1;
+
+        lock.unlock();
+        write_chunk(index);
+        lock.lock();
+
+        m_pending = false;
+        m_cv.notify_all();
+    }
+}
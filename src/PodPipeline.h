@@ -0,0 +1,140 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_PIPELINE_H
+#define POD_PIPELINE_H
+
+#include "pod_io.h"
+#include "PodFile.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Reads a range of a file on a background thread, one chunk ahead of the caller
+// The file must not be used by anything else until stop() is called.
+class ReadAhead
+{
+public:
+
+    // Read up to size bytes from the current offset of file, in chunks of chunkSize bytes
+    // if checksum isn't POD_CHECKSUM_NONE, then each chunk is checksummed on the thread that reads it
+    ReadAhead(File& file, uint64_t size, size_t chunkSize, pod_checksum_t checksum = POD_CHECKSUM_NONE);
+
+    ReadAhead(const ReadAhead&) = delete;
+
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    // Calls stop()
+    ~ReadAhead();
+
+    // Returns the next chunk, which stays valid until next() is called again or the reader is destroyed
+    // count is set to the number of bytes, which is 0 at the end of the range or after a failed read
+    const uint8_t* next(size_t& count);
+
+    // Stop reading ahead, and move the file to the end of the last chunk returned by next()
+    void stop();
+
+    // Returns check32 updated with every byte returned by next(), except the last unused bytes of the last chunk
+    // (only if the reader was created with a checksum type)
+    [[nodiscard]]
+    uint32_t checksum(uint32_t check32, size_t unused) const;
+
+protected:
+    void run();
+
+    File& m_file;
+    pod_checksum_t m_checksum;
+    uint64_t m_start;                  // offset of the first chunk
+    uint64_t m_remaining;              // number of bytes left to read
+    uint64_t m_returned;               // number of bytes returned by next()
+    size_t m_chunkSize;
+
+    std::vector<uint8_t> m_chunks[2];
+    size_t m_counts[2];                // number of bytes read into each chunk
+    uint32_t m_checks[2];              // checksum of each chunk
+    uint32_t m_releasedCheck32;        // checksum of the chunks released by next()
+    uint64_t m_released;               // number of bytes in the chunks released by next()
+    size_t m_filled;                   // number of chunks read and not yet released by next()
+    size_t m_readIndex;                // chunk that the thread reads into next
+    size_t m_nextIndex;                // chunk that next() returns next
+    bool m_held;                       // true if the caller holds the last chunk returned by next()
+    bool m_done;                       // true once the thread has read the last chunk
+    bool m_stop;
+    bool m_stopped;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+// Writes to a file on a background thread, one chunk behind the caller
+// The file must not be used by anything else until finish() is called.
+// The thread is only started once a chunk is filled, so small files are written on the calling thread.
+// Bytes can also be checksummed by the thread that writes them, instead of by the caller.
+class WriteBehind
+{
+public:
+
+    // Write to the current offset of file in chunks of chunkSize bytes
+    // if checksum isn't POD_CHECKSUM_NONE, then the written bytes are checksummed, continuing from check32
+    WriteBehind(File& file, size_t chunkSize, pod_checksum_t checksum = POD_CHECKSUM_NONE, uint32_t check32 = 0);
+
+    WriteBehind(const WriteBehind&) = delete;
+
+    WriteBehind& operator=(const WriteBehind&) = delete;
+
+    // Calls finish()
+    ~WriteBehind();
+
+    // Queue size bytes to be written
+    void write(const uint8_t* data, size_t size);
+
+    // Write every queued byte and stop the thread
+    void finish();
+
+    // Mark the end of a span of the queued bytes that has a checksum of its own (see mark_checks)
+    void mark();
+
+    // Returns true if the written bytes are checksummed
+    [[nodiscard]]
+    bool checksummed() const;
+
+    // Returns the running checksum of every written byte (only valid once finished)
+    [[nodiscard]]
+    uint32_t check32() const;
+
+    // Returns the checksum of the bytes before every mark, since the last one (only valid once finished)
+    [[nodiscard]]
+    const std::vector<uint32_t>& mark_checks() const;
+
+protected:
+    void run();
+
+    // Pass the current chunk to the thread
+    void submit();
+
+    // Write a chunk and checksum it
+    void write_chunk(size_t index);
+
+    File& m_file;
+    size_t m_chunkSize;
+    pod_checksum_t m_checksum;
+    uint32_t m_check32;                // running checksum of the written bytes
+    uint32_t m_markCheck32;            // checksum of the written bytes since the last mark
+    std::vector<uint32_t> m_markChecks;
+
+    std::vector<uint8_t> m_chunks[2];
+    std::vector<size_t> m_marks[2];    // marks in each chunk, as offsets from its start
+    size_t m_current;                  // chunk that write() copies to
+    bool m_pending;                    // true while the thread writes the other chunk
+    bool m_stop;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+#endif
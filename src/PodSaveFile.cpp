@@ -2,121 +2,253 @@
 // Kyle J Burgess
 
 #include "pod_io.h"
+#include "PodBlock.h"
 #include "PodBytes.h"
 #include "PodTypes.h"
 #include "PodDeflate.h"
-#include "PodLookup.h"
-
+#include "PodHeader.h"
+#include "PodIndex.h"
+#include "PodChecksum.h"
+#include "PodCodec.h"
+#include "PodConfig.h"
+#include "PodLazy.h"
+#include "PodWriter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
 
 #include "PodFile.h"
+#include "PodLookup.h"
 
+// Returns the save options that change the bytes of a block, for PodBlockCache::options
+static uint32_t blockCacheOptions(const PodHeader& header, pod_compression_t compression, bool reverseBytes)
+{
+    // only DEFLATE has compression levels
+    uint32_t level = (header.codec == CODEC_DEFLATE) ? static_cast<uint32_t>(compression) : 0;
+    uint32_t filtered = ((header.flags & POD_FLAGS_FILTER) != 0) ? 1 : 0;
+    uint32_t count64 = ((header.flags & POD_FLAGS_COUNT64) != 0) ? 1 : 0;
+    uint32_t aligned = ((header.flags & POD_FLAGS_ALIGN) != 0) ? 1 : 0;
+
+    return 1u | (static_cast<uint32_t>(header.codec) << 1) | (level << 8) | ((reverseBytes ? 1u : 0u) << 16) | (filtered << 17) | (count64 << 18) | (aligned << 19);
+}
+
+// Write the blocks of a container, followed by the index and checksum
+// kept are index entries of blocks already in the file (see pod_append_file)
+// if releaseLazy is set, lazy items are inflated one at a time and released once written
 template<bool reverse_bytes>
-pod_result_t writeBytes(pod_container_t* container, File& file, pod_compression_t compression, pod_checksum_t checksum, uint32_t check32)
+pod_result_t writeBytes(pod_container_t* container, File& file, const PodHeader& header, pod_compression_t compression, uint32_t check32, const std::vector<PodIndexEntry>& kept = {}, bool releaseLazy = false)
 {
     auto& map = container->map;
 
     std::vector<uint8_t> buffer;
+    std::vector<PodIndexEntry> index;
+
+    bool indexed = (header.flags & POD_FLAGS_INDEX) != 0;
+
+    if (indexed)
+    {
+        index.reserve(map.size() + kept.size());
+    }
+
+    uint64_t bodyOffset = file.tell();
 
     compress_stream cs {};
-    if (deflate_init(cs, &file, compression, checksum, check32) != COMPRESS_SUCCESS)
+    if (deflate_init(cs, &file, header.codec, compression, header.checksum, check32) != COMPRESS_SUCCESS)
     {
         return POD_ZLIB_ERROR;
     }
 
-    for (auto& pair : map)
-    {
-        const auto& key = pair.first;
-        auto& data = pair.second;
+    cs.block_checks = (header.flags & POD_FLAGS_BLOCK_CHECKSUM) != 0;
+
+    // Blocks of indexed files can be inflated on their own, so the blocks of unchanged items
+    // are copied from the last save, and the blocks of other items are kept for the next one
+    // stored blocks aren't kept, since copying them costs as much as storing the values
+    // blocks are only kept when asked for (see pod_set_block_cache), since they hold a copy of every item
 
-        // Write header
+    bool keepBlocks = config_block_cache();
+    bool cached = keepBlocks && indexed && !releaseLazy && (header.codec != CODEC_STORE);
+    uint32_t cacheOptions = blockCacheOptions(header, compression, reverse_bytes);
 
-        // 8 byte-aligned header
-        //    [4] key size
-        //    [4] value count
-        //    [4] type
-        //    [?] key
+    std::vector<uint8_t> captured;
+    std::vector<PodData*> recached;
 
-        size_t headerSize = 12 + key.size();
-        buffer.resize(headerSize);
+    if (cached)
+    {
+        recached.reserve(map.size());
+        cs.capture = &captured;
+    }
 
-        set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(key.size()), 0, 4);
-        set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(data.count), 4, 4);
-        set_bytes<uint32_t, reverse_bytes>(buffer, static_cast<uint32_t>(data.type), 8, 4);
-        set_bytes<uint8_t , reverse_bytes>(buffer, key.data(), 12, key.size());
+    for (auto& item : map)
+    {
+        const auto& key = item.key;
+        auto& data = item.data;
 
-        if (deflate_next(cs, buffer.data(), buffer.size()) != COMPRESS_SUCCESS)
+        if (!keepBlocks)
         {
-            return POD_ZLIB_ERROR;
+            data.cache = PodBlockCache();
         }
 
-        // Write data
-
-        // 8 byte-aligned data
-        //    [?] data
-
-        if constexpr (reverse_bytes)
+        if (releaseLazy)
         {
-            buffer.resize(data.values.size());
+            pod_result_t result = load_values(data);
 
-            switch(data.type)
+            if (result != POD_SUCCESS)
             {
-                case POD_ASCII_CHAR8:
-                case POD_UTF8_CHAR8:
-                case POD_UINT8:
-                case POD_INT8:
-                    set_bytes<uint8_t , reverse_bytes>(buffer, data.values.data(), 0, data.values.size());
-                    break;
-                case POD_UINT16:
-                case POD_INT16:
-                    set_bytes<uint16_t, reverse_bytes>(buffer, data.values.data(), 0, data.values.size());
-                    break;
-                case POD_UINT32:
-                case POD_INT32:
-                case POD_FLOAT32:
-                    set_bytes<uint32_t, reverse_bytes>(buffer, data.values.data(), 0, data.values.size());
-                    break;
-                case POD_UINT64:
-                case POD_INT64:
-                case POD_FLOAT64:
-                    set_bytes<uint64_t, reverse_bytes>(buffer, data.values.data(), 0, data.values.size());
-                    break;
+                return result;
             }
+        }
 
-            if (deflate_next(cs, buffer.data(), buffer.size()) != COMPRESS_SUCCESS)
-            {
-                return POD_ZLIB_ERROR;
-            }
+        // Every block starts on a flush boundary, so it can be inflated on its own
+        // the offset is filled in after deflate_end(), once every flush point is written
+
+        if (indexed)
+        {
+            index.push_back(
+                {
+                    .key = std::string(key),
+                    .offset = 0,
+                    .count = data.count,
+                    .type = data.type,
+                    .filter = ((header.flags & POD_FLAGS_FILTER) != 0) ? data.filter : POD_FILTER_NONE,
+                });
         }
-        else
+
+        if (cached && !data.dirty && (data.cache.options == cacheOptions) && data.cache.bytes && !data.cache.bytes->empty())
         {
-            if (deflate_next(cs, data.values.data(), data.values.size()) != COMPRESS_SUCCESS)
+            if (deflate_copy_block(cs, data.cache.bytes->data(), data.cache.bytes->size()) != COMPRESS_SUCCESS)
             {
                 return POD_ZLIB_ERROR;
             }
+
+            recached.push_back(nullptr);
+            continue;
         }
+
+        if (deflate_block<reverse_bytes>(cs, buffer, key, data, header.flags) != COMPRESS_SUCCESS)
+        {
+            return POD_ZLIB_ERROR;
+        }
+
+        if (indexed && (deflate_flush(cs) != COMPRESS_SUCCESS))
+        {
+            return POD_ZLIB_ERROR;
+        }
+
+        if (cached)
+        {
+            recached.push_back(&data);
+        }
+
+        if (releaseLazy && data.lazy)
+        {
+            data.values.clear();
+            data.pending = true;
+        }
+    }
+
+    pod_result_t result = write_trailer<reverse_bytes>(file, header, cs, index, bodyOffset, kept, buffer);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
     }
 
-    if (deflate_end(cs) != COMPRESS_SUCCESS)
+    // Keep the blocks that were compressed
+
+    for (size_t i = 0; i != recached.size(); ++i)
     {
-        return POD_ZLIB_ERROR;
+        if (recached[i] != nullptr)
+        {
+            auto& cache = recached[i]->cache;
+            uint64_t begin = (i == 0) ? 0 : cs.flushes[i - 1];
+
+            cache.bytes = std::make_shared<const std::vector<uint8_t>>(captured.begin() + begin, captured.begin() + cs.flushes[i]);
+            cache.options = cacheOptions;
+            recached[i]->dirty = false;
+        }
     }
 
-    // Write checksum
-    if (checksum != POD_CHECKSUM_NONE)
+    return POD_SUCCESS;
+}
+
+// Inflate the values of every lazy item in a container
+static pod_result_t loadLazyValues(pod_container_t* container)
+{
+    for (auto& item : container->map)
     {
-        buffer.resize(4);
-        set_bytes<uint32_t, reverse_bytes>(buffer, cs.check32, 0, 4);
-        file.write(buffer.data(), buffer.size());
+        pod_result_t result = load_values(item.data);
+
+        if (result != POD_SUCCESS)
+        {
+            return result;
+        }
     }
 
     return POD_SUCCESS;
 }
 
-pod_result_t pod_save_file(pod_container_t* container, const char* fileName, pod_compression_t compression, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness)
+// Returns true if an item of a container has too many values for a file without POD_FLAGS_COUNT64
+static bool needsCount64(const pod_container_t* container)
 {
-    // Open File
+    for (const auto& item : container->map)
+    {
+        if (item.data.count > cMaxCount32)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Write a container to an open file
+static pod_result_t saveStream(pod_container_t* container, File& file, compress_codec codec, pod_compression_t compression, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    // Write header
+    // files only use 64-bit counts when an item needs them, so they stay readable by older versions otherwise
+
+    if (needsCount64(container))
+    {
+        flags = static_cast<pod_flags_t>(flags | POD_FLAGS_COUNT64);
+    }
+
+    PodHeader header;
+
+    pod_result_t result = write_header(file, header, endianness, checksum, codec, flags, checksumValue);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // Write endian-dependent blocks
+
+    if (requires_byte_swap(header.endian))
+    {
+        result = writeBytes<true>(container, file, header, compression, checksumValue);
+    }
+    else
+    {
+        result = writeBytes<false>(container, file, header, compression, checksumValue);
+    }
+
+    if ((result == POD_SUCCESS) && file.failed())
+    {
+        return POD_FILE_NOT_FOUND;
+    }
 
+    return result;
+}
+
+// Write a container to a file
+static pod_result_t writeFile(pod_container_t* container, const char* fileName, compress_codec codec, pod_compression_t compression, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
     File file(fileName, FM_WRITE);
 
     if (!file.is_open())
@@ -124,95 +256,446 @@ pod_result_t pod_save_file(pod_container_t* container, const char* fileName, pod
         return POD_FILE_NOT_FOUND;
     }
 
-    // Write header
+    return saveStream(container, file, codec, compression, checksum, checksumValue, endianness, flags);
+}
 
-    uint8_t header[16];
+static pod_result_t saveFile(pod_container_t* container, const char* fileName, compress_codec codec, pod_compression_t compression, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    // Inflate lazy items first, the file they are read from may be the one being replaced
 
-    // "PODS"
+    pod_result_t result = loadLazyValues(container);
 
-    memcpy(header, cPODX, 4);
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
 
-    // Endian
+    return writeFile(container, fileName, codec, compression, checksum, checksumValue, endianness, flags);
+}
 
-    switch(endianness)
+pod_result_t pod_save_file(pod_container_t* container, const char* fileName, pod_compression_t compression, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness)
+{
+    return saveFile(container, fileName, CODEC_DEFLATE, compression, checksum, checksumValue, endianness, POD_FLAGS_NONE);
+}
+
+pod_result_t pod_save_file_ex(pod_container_t* container, const char* fileName, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    compress_codec streamCodec;
+
+    if (!to_compress_codec(codec, compression, streamCodec))
     {
-        case POD_ENDIAN_LITTLE:
-            memcpy(header + 4, cLITE, 4);
-            break;
-        case POD_ENDIAN_BIG:
-            memcpy(header + 4, cBIGE, 4);
-            break;
-        case POD_ENDIAN_NATIVE:
-            if (is_little_endian())
-            {
-                memcpy(header + 4, cLITE, 4);
-            }
-            else if (is_big_endian())
-            {
-                memcpy(header + 4, cBIGE, 4);
-            }
-            else
+        return POD_ARGUMENT_ERROR;
+    }
+
+    return saveFile(container, fileName, streamCodec, compression, checksum, checksumValue, endianness, flags);
+}
+
+// A save that runs on a background thread (see pod_save_file_async)
+struct pod_save_t
+{
+    pod_container_t snapshot;               // copy of the container that shares its values
+    std::string fileName;                   // file being written
+    std::future<pod_result_t> result;       // ready once the file is written
+};
+
+pod_result_t pod_save_file_async(pod_save_t** save, pod_container_t* container, const char* fileName, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    if ((save == nullptr) || (container == nullptr) || (fileName == nullptr))
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    compress_codec streamCodec;
+
+    if (!to_compress_codec(codec, compression, streamCodec))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    // Inflate lazy items first, the file they are read from may be the one being replaced
+
+    pod_result_t result = loadLazyValues(container);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // Items of the snapshot share their values, mappings, and cached blocks with the container
+    // the save is only handed to the caller once its thread is running
+
+    return catch_alloc([&]()
+    {
+        auto ptr = std::make_unique<pod_save_t>();
+        ptr->snapshot.map = container->map;
+        ptr->fileName = fileName;
+
+        auto raw = ptr.get();
+
+        try
+        {
+            ptr->result = std::async(std::launch::async, [raw, streamCodec, compression, checksum, checksumValue, endianness, flags]()
             {
-                return POD_ARGUMENT_ERROR;
-            }
-            break;
-        default:
-            return POD_ARGUMENT_ERROR;
+                return writeFile(&raw->snapshot, raw->fileName.c_str(), streamCodec, compression, checksum, checksumValue, endianness, flags);
+            });
+        }
+        catch (const std::system_error&)
+        {
+            // no thread could be started
+            return POD_OUT_OF_RANGE;
+        }
+
+        *save = ptr.release();
+
+        return POD_SUCCESS;
+    });
+}
+
+pod_result_t pod_save_poll(pod_save_t* save, uint32_t* finished)
+{
+    if ((save == nullptr) || (finished == nullptr))
+    {
+        return POD_NULL_REFERENCE;
     }
 
-    // Checksum
+    *finished = (save->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) ? 1 : 0;
 
-    switch(checksum)
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_save_wait(pod_save_t* save)
+{
+    if (save == nullptr)
     {
-        case POD_CHECKSUM_NONE:
-            memcpy(header + 8, cNONE, 4);
-            break;
-        case POD_CHECKSUM_ADLER32:
-            memcpy(header + 8, cAD32, 4);
-            break;
-        case POD_CHECKSUM_CRC32:
-            memcpy(header + 8, cCR32, 4);
-            break;
-        default:
-            return POD_ARGUMENT_ERROR;
+        return POD_NULL_REFERENCE;
     }
 
-    // Reserved Bytes
-    memcpy(header + 12, cNONE, 4);
+    pod_result_t result = save->result.get();
 
-    file.write(header, 16);
+    delete save;
 
-    // Compute checksum
-    if (checksum == POD_CHECKSUM_ADLER32)
+    return result;
+}
+
+pod_result_t pod_save_memory(pod_container_t* container, void** buffer, uint64_t* size, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    if ((container == nullptr) || (buffer == nullptr) || (size == nullptr))
     {
-        checksumValue = adler32(checksumValue, header, 16);
+        return POD_NULL_REFERENCE;
     }
-    else if (checksum == POD_CHECKSUM_CRC32)
+
+    compress_codec streamCodec;
+
+    if (!to_compress_codec(codec, compression, streamCodec))
     {
-        checksumValue = crc32(checksumValue, header, 16);
+        return POD_ARGUMENT_ERROR;
     }
 
-    // Write endian-dependent blocks
+    pod_result_t result = loadLazyValues(container);
 
-    bool requiresByteSwap =
-        (endianness == POD_ENDIAN_LITTLE && is_big_endian()) ||
-        (endianness == POD_ENDIAN_BIG && is_little_endian());
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
 
-    pod_result_t result;
+    File file(nullptr, 0, true);
+
+    result = saveStream(container, file, streamCodec, compression, checksum, checksumValue, endianness, flags);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    *size = file.size();
+    *buffer = file.release();
 
-    if (requiresByteSwap)
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_save_memory_into(pod_container_t* container, void* buffer, uint64_t capacity, uint64_t* size, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    if ((container == nullptr) || (size == nullptr) || (buffer == nullptr && capacity != 0))
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    compress_codec streamCodec;
+
+    if (!to_compress_codec(codec, compression, streamCodec))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    pod_result_t result = loadLazyValues(container);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // bytes that don't fit are still counted, so the required size is known
+    File file(static_cast<uint8_t*>(buffer), capacity, false);
+
+    result = saveStream(container, file, streamCodec, compression, checksum, checksumValue, endianness, flags);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    *size = file.size();
+
+    return (file.size() > capacity) ? POD_OUT_OF_RANGE : POD_SUCCESS;
+}
+
+void pod_free_memory(void* buffer)
+{
+    free(buffer);
+}
+
+pod_result_t pod_save_stream(pod_container_t* container, const pod_stream_t* stream, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    if ((container == nullptr) || (stream == nullptr))
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    compress_codec streamCodec;
+
+    if (!to_compress_codec(codec, compression, streamCodec))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    pod_result_t result = loadLazyValues(container);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    File file(*stream, FM_WRITE);
+
+    if (!file.is_open())
+    {
+        return POD_FILE_NOT_FOUND;
+    }
+
+    return saveStream(container, file, streamCodec, compression, checksum, checksumValue, endianness, flags);
+}
+
+// Append the items of a container to a file saved with POD_FLAGS_APPEND
+// the file position is anywhere after the header
+template<bool reverse_bytes>
+pod_result_t appendBytes(pod_container_t* container, File& file, const PodHeader& header, pod_compression_t compression)
+{
+    std::vector<PodIndexEntry> index;
+    uint64_t indexOffset;
+
+    pod_result_t result = read_index<reverse_bytes>(index, file, header, indexOffset);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // Blocks of keys that aren't in the container stay where they are
+
+    auto& map = container->map;
+    std::vector<PodIndexEntry> kept;
+
+    for (auto& entry : index)
+    {
+        if (map.find(entry.key) == nullptr)
+        {
+            kept.push_back(std::move(entry));
+        }
+    }
+
+    // The segment replaces the trailing checksum, and the checksum continues from its value
+
+    uint64_t end = file.size() - checksum_size(header.checksum);
+    uint32_t check32 = 0;
+
+    if (header.checksum != POD_CHECKSUM_NONE)
+    {
+        std::vector<uint8_t> buffer(4);
+
+        if (!file.seek(end) || (file.read(buffer.data(), 4) != 4))
+        {
+            return POD_FILE_CORRUPT;
+        }
+
+        get_bytes<uint32_t, reverse_bytes>(check32, buffer, 0, 4);
+    }
+
+    if (!file.seek(end))
+    {
+        return POD_FILE_CORRUPT;
+    }
+
+    // Aligned segments start on a cBlockAlignment boundary
+
+    if ((header.flags & POD_FLAGS_ALIGN) != 0)
+    {
+        uint8_t padding[cBlockAlignment] = {};
+        size_t paddingSize = next_multiple_of(end, cBlockAlignment) - end;
+
+        if (file.write(padding, paddingSize) != paddingSize)
+        {
+            return POD_FILE_NOT_FOUND;
+        }
+
+        check32 = checksum_update(header.checksum, check32, padding, paddingSize);
+    }
+
+    return writeBytes<reverse_bytes>(container, file, header, compression, check32, kept);
+}
+
+pod_result_t pod_append_file(pod_container_t* container, const char* fileName, pod_compression_t compression, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    if (container == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    // Inflate lazy items first, the file they are read from may be the one being appended to
+
+    pod_result_t result = loadLazyValues(container);
+
+    if (result != POD_SUCCESS)
     {
-        result = writeBytes<true>(container, file, compression, checksum, checksumValue);
+        return result;
+    }
+
+    File file(fileName, FM_UPDATE);
+
+    if (!file.is_open())
+    {
+        return POD_FILE_NOT_FOUND;
+    }
+
+    // Read header
+
+    PodHeader header;
+
+    result = read_header(file, header, checksum, checksumValue);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    if ((header.flags & POD_FLAGS_APPEND) == 0)
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    if (((header.flags & POD_FLAGS_COUNT64) == 0) && needsCount64(container))
+    {
+        return POD_OUT_OF_RANGE;
+    }
+
+    if (requires_byte_swap(header.endian))
+    {
+        return appendBytes<true>(container, file, header, compression);
     }
     else
     {
-        result = writeBytes<false>(container, file, compression, checksum, checksumValue);
+        return appendBytes<false>(container, file, header, compression);
+    }
+}
+
+pod_result_t pod_compact_file(const char* fileName, pod_compression_t compression, pod_checksum_t checksum, uint32_t checksumValue)
+{
+    std::string tmpName = std::string(fileName) + ".tmp";
+    pod_result_t result;
+
+    {
+        PodHeader header;
+
+        {
+            File file(fileName, FM_READ);
+
+            if (!file.is_open())
+            {
+                return POD_FILE_NOT_FOUND;
+            }
+
+            uint32_t check32 = checksumValue;
+
+            result = read_header(file, header, checksum, check32);
+
+            if (result != POD_SUCCESS)
+            {
+                return result;
+            }
+
+            // the blocks are copied under a new checksum, so the old one has to hold first
+
+            result = verify_checksum(file, header, check32);
+
+            if (result != POD_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        // Read the live blocks through the index of the last segment
+
+        pod_container_t container;
+
+        result = pod_load_file_lazy(&container, fileName, checksum, checksumValue);
+
+        if (result != POD_SUCCESS)
+        {
+            return result;
+        }
+
+        // Write a single segment with the options of the original file
+
+        File file(tmpName.c_str(), FM_WRITE);
+
+        if (!file.is_open())
+        {
+            return POD_FILE_NOT_FOUND;
+        }
+
+        uint32_t check32 = checksumValue;
+
+        result = write_header(file, header, header.endian, header.checksum, header.codec, header.flags, check32);
+
+        if (result == POD_SUCCESS)
+        {
+            if (requires_byte_swap(header.endian))
+            {
+                result = writeBytes<true>(&container, file, header, compression, check32, {}, true);
+            }
+            else
+            {
+                result = writeBytes<false>(&container, file, header, compression, check32, {}, true);
+            }
+        }
     }
 
     if (result != POD_SUCCESS)
     {
+        std::remove(tmpName.c_str());
         return result;
     }
 
+    // Replace the file once every handle to it is closed
+
+#ifdef _WIN32
+    std::remove(fileName);
+#endif
+
+    if (std::rename(tmpName.c_str(), fileName) != 0)
+    {
+        std::remove(tmpName.c_str());
+        return POD_FILE_NOT_FOUND;
+    }
+
     return POD_SUCCESS;
 }
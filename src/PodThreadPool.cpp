@@ -0,0 +1,74 @@
+// pod-io
+// Kyle J Burgess
+
+#include "PodThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_stop(false)
+{
+    m_threads.reserve(threadCount);
+
+    for (size_t i = 0; i != threadCount; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cv.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packagedTask(std::move(task));
+    auto future = packagedTask.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(packagedTask));
+    }
+
+    m_cv.notify_one();
+
+    return future;
+}
+
+size_t ThreadPool::size() const
+{
+    return m_threads.size();
+}
+
+void ThreadPool::run()
+{
+    while (true)
+    {
+        std::packaged_task<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]{ return m_stop || !m_tasks.empty(); });
+
+            // finish queued tasks before stopping
+            if (m_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,47 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_THREAD_POOL_H
+#define POD_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A fixed number of worker threads that run tasks in submission order
+class ThreadPool
+{
+public:
+
+    explicit ThreadPool(size_t threadCount);
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Waits for every submitted task to finish
+    ~ThreadPool();
+
+    // Queue a task
+    // returns a future that is ready once the task has run
+    std::future<void> submit(std::function<void()> task);
+
+    // Returns the number of worker threads
+    [[nodiscard]]
+    size_t size() const;
+
+protected:
+    void run();
+
+    std::vector<std::thread> m_threads;
+    std::queue<std::packaged_task<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop;
+};
+
+#endif
@@ -5,23 +5,314 @@
 #define POD_TYPES_H
 
 #include "pod_io.h"
+#include "PodMappedFile.h"
 
-#include <unordered_map>
-#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
+
+struct LazyFile;
+
+// Values of an item
+// The bytes are shared with snapshots of the container (see pod_save_file_async),
+// so they are never written while shared, and allocate() gives the item new bytes instead.
+class PodValues
+{
+public:
+
+    // Returns size bytes to write the values to, replacing the current values
+    uint8_t* allocate(size_t size)
+    {
+        if (m_bytes && (m_bytes.use_count() == 1))
+        {
+            m_bytes->resize(size);
+        }
+        else
+        {
+            m_bytes = std::make_shared<std::vector<uint8_t>>(size);
+        }
+
+        return m_bytes->data();
+    }
+
+    // Release the values
+    void clear()
+    {
+        m_bytes.reset();
+    }
+
+    [[nodiscard]]
+    const uint8_t* data() const
+    {
+        return m_bytes ? m_bytes->data() : nullptr;
+    }
+
+    [[nodiscard]]
+    size_t size() const
+    {
+        return m_bytes ? m_bytes->size() : 0;
+    }
+
+protected:
+    std::shared_ptr<std::vector<uint8_t>> m_bytes;
+};
+
+// Compressed block of an item, kept from the last indexed save
+// so that the block can be written again without compressing the values
+struct PodBlockCache
+{
+    std::shared_ptr<const std::vector<uint8_t>> bytes; // block bytes between two flush points, or null
+    uint32_t options = 0;                    // codec, level, and byte order the bytes were saved with
+};
 
 struct PodData
 {
-    std::vector<uint8_t> values;
+    PodValues values;
     size_t count;
     pod_type_t type;
+    uint32_t filter = POD_FILTER_NONE;       // filter applied to the values when saved (pod_filter_t)
+    const uint8_t* mapped = nullptr;         // values in a file mapping, used instead of values if not null
+    std::shared_ptr<MappedFile> mapping;     // keeps the file mapping alive
+    std::shared_ptr<LazyFile> lazy;          // file to inflate the values from on first access
+    uint64_t offset = 0;                     // offset of the block in the lazy file
+    uint64_t storedSize = 0;                 // stored size of the block in the lazy file (POD_FLAGS_BLOCK_CHECKSUM only)
+    uint32_t check32 = 0;                    // checksum of the block in the lazy file (POD_FLAGS_BLOCK_CHECKSUM only)
+    bool pending = false;                    // true until the values are inflated from the lazy file
+    bool dirty = true;                       // true if the values changed since the block was cached
+    PodBlockCache cache;                     // compressed block from the last indexed save
+
+    // Returns a pointer to the first byte of the values
+    [[nodiscard]]
+    const uint8_t* data() const
+    {
+        return (mapped != nullptr) ? mapped : values.data();
+    }
+
+    // Release any file that the values are read from
+    void release()
+    {
+        mapped = nullptr;
+        mapping.reset();
+        lazy.reset();
+        offset = 0;
+        storedSize = 0;
+        check32 = 0;
+        pending = false;
+        dirty = true;
+        cache = PodBlockCache();
+    }
+};
+
+// Item of a container, which a pod_item_t handle points to
+struct PodItem
+{
+    std::string_view key;                    // key bytes, stored in the key arena of the map
+    PodData data;
+    PodItem* prev = nullptr;                 // previous item in insertion order
+    PodItem* next = nullptr;                 // next item in insertion order
+    uint32_t hash = 0;                       // hash of the key
+    bool used = false;                       // false until the item is added, and once it is removed
 };
 
-using PodMap = std::unordered_map<std::string, PodData>;
+// Items of a container, found by key in an open addressing table with linear probing
+// Items are allocated in blocks that never move, so a pointer to an item stays valid until it is removed,
+// and keys are copied into an arena of large chunks instead of a string per item.
+// Items are linked in insertion order, and new items fill the blocks in order,
+// so unless items are removed, iterating walks the blocks from start to end.
+class PodMap
+{
+public:
+
+    // Iterates over the items in insertion order
+    template<class Item>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PodItem;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Item*;
+        using reference = Item&;
+
+        explicit Iterator(Item* item)
+            : m_item(item)
+        {
+        }
+
+        Item& operator*() const
+        {
+            return *m_item;
+        }
+
+        Item* operator->() const
+        {
+            return m_item;
+        }
+
+        Iterator& operator++()
+        {
+            m_item = m_item->next;
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return m_item == other.m_item;
+        }
+
+        bool operator!=(const Iterator& other) const
+        {
+            return m_item != other.m_item;
+        }
+
+    protected:
+        Item* m_item;
+    };
+
+    using iterator = Iterator<PodItem>;
+    using const_iterator = Iterator<const PodItem>;
+
+    PodMap() = default;
+
+    // Copies every item, the copy has its own blocks and key arena
+    PodMap(const PodMap& other);
+
+    PodMap(PodMap&&) noexcept = default;
+
+    PodMap& operator=(const PodMap& other);
+
+    PodMap& operator=(PodMap&&) noexcept = default;
+
+    // Returns the hash of a key, which is the same in every map
+    static uint32_t hashOf(std::string_view key);
+
+    // Returns the item with a key, or nullptr
+    [[nodiscard]]
+    PodItem* find(std::string_view key) const
+    {
+        return find(key, hashOf(key));
+    }
+
+    // Returns the item with a key and its hash, or nullptr
+    [[nodiscard]]
+    PodItem* find(std::string_view key, uint32_t hash) const;
+
+    // Returns the item with a key, adding an item with no values if there isn't one
+    PodItem& insert(std::string_view key)
+    {
+        return insert(key, hashOf(key));
+    }
+
+    // Returns the item with a key and its hash, adding an item with no values if there isn't one
+    PodItem& insert(std::string_view key, uint32_t hash);
+
+    // Returns the data of the item with a key, adding it if needed
+    PodData& operator[](std::string_view key)
+    {
+        return insert(key).data;
+    }
+
+    // Remove an item, does nothing if the item was already removed
+    // the items before and after it stay in the same order
+    void erase(PodItem& item);
+
+    // Remove the item with a key, if there is one
+    void erase(std::string_view key);
+
+    // Make room for count items, so adding them doesn't grow the table
+    void reserve(size_t count);
+
+    // Remove every item
+    void clear();
+
+    [[nodiscard]]
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    // Returns the first item in insertion order, or nullptr
+    [[nodiscard]]
+    PodItem* first() const
+    {
+        return m_first;
+    }
+
+    iterator begin() { return iterator(m_first); }
+    iterator end() { return iterator(nullptr); }
+    const_iterator begin() const { return const_iterator(m_first); }
+    const_iterator end() const { return const_iterator(nullptr); }
+
+protected:
+    // Table entry, item is nullptr if the slot is empty
+    struct Slot
+    {
+        uint32_t hash;
+        PodItem* item;
+    };
+
+    // Returns an unused item
+    PodItem* allocateItem();
+
+    // Copy a key into the arena
+    std::string_view storeKey(std::string_view key);
+
+    // Copy the keys of the items in use into a new arena, once most of the arena belongs to removed items
+    void compactKeys();
+
+    // Resize the table to slotCount slots, a power of two
+    void rehash(size_t slotCount);
+
+    std::vector<std::unique_ptr<PodItem[]>> m_blocks;  // block n holds (cFirstBlockSize << n) items
+    std::vector<PodItem*> m_free;                      // removed items, reused before allocating new ones
+    size_t m_block = 0;                                // block that new items are allocated from
+    size_t m_blockUsed = 0;                            // number of items allocated from that block
+    size_t m_size = 0;                                 // number of items in use
+    PodItem* m_first = nullptr;                        // first item in insertion order
+    PodItem* m_last = nullptr;                         // last item in insertion order
+
+    std::vector<Slot> m_slots;
+
+    std::vector<std::unique_ptr<char[]>> m_keyChunks;
+    size_t m_keyChunkSize = 0;                         // size of the last chunk
+    size_t m_keyChunkUsed = 0;                         // bytes used in the last chunk
+    size_t m_keyBytes = 0;                             // bytes of the keys of items in use
+    size_t m_deadKeyBytes = 0;                         // bytes of the keys of removed items
+};
 
 struct pod_container_t
 {
     PodMap map;
 };
 
+struct pod_key_t
+{
+    std::string key;
+    uint32_t hash;                           // PodMap::hashOf(key)
+};
+
+// Returns the result of f(), or POD_OUT_OF_RANGE if f runs out of memory
+// so allocation failures never throw through the C interface
+template<class F>
+pod_result_t catch_alloc(F&& f)
+{
+    try
+    {
+        return f();
+    }
+    catch (const std::length_error&)
+    {
+        return POD_OUT_OF_RANGE;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return POD_OUT_OF_RANGE;
+    }
+}
+
 #endif
@@ -0,0 +1,195 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+#include "PodWriter.h"
+#include "PodBlock.h"
+#include "PodCodec.h"
+#include "PodFilter.h"
+#include "PodLookup.h"
+#include "PodTypes.h"
+
+#include <memory>
+
+// Deflate an item straight from the caller's values
+template<bool reverse_bytes>
+pod_result_t writeItem(pod_writer_t& writer, const std::string& key, const PodData& data)
+{
+    bool indexed = (writer.header.flags & POD_FLAGS_INDEX) != 0;
+
+    if (indexed)
+    {
+        writer.index.push_back(
+            {
+                .key = key,
+                .offset = 0,
+                .count = data.count,
+                .type = data.type,
+                .filter = ((writer.header.flags & POD_FLAGS_FILTER) != 0) ? data.filter : POD_FILTER_NONE,
+            });
+    }
+
+    if (deflate_block<reverse_bytes>(writer.cs, writer.buffer, key, data, writer.header.flags) != COMPRESS_SUCCESS)
+    {
+        return POD_ZLIB_ERROR;
+    }
+
+    if (indexed && (deflate_flush(writer.cs) != COMPRESS_SUCCESS))
+    {
+        return POD_ZLIB_ERROR;
+    }
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_writer_open(pod_writer_t** writer, const char* fileName, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, uint32_t checksumValue, pod_endian_t endianness, pod_flags_t flags)
+{
+    if (writer == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    *writer = nullptr;
+
+    compress_codec streamCodec;
+
+    if (!to_compress_codec(codec, compression, streamCodec))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    auto w = std::make_unique<pod_writer_t>(fileName);
+
+    if (!w->file.is_open())
+    {
+        return POD_FILE_NOT_FOUND;
+    }
+
+    // Write header
+
+    pod_result_t result = write_header(w->file, w->header, endianness, checksum, streamCodec, flags, checksumValue);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    // Start the body
+
+    w->bodyOffset = w->file.tell();
+
+    if (deflate_init(w->cs, &w->file, streamCodec, compression, checksum, checksumValue) != COMPRESS_SUCCESS)
+    {
+        return POD_ZLIB_ERROR;
+    }
+
+    w->cs.block_checks = (w->header.flags & POD_FLAGS_BLOCK_CHECKSUM) != 0;
+
+    *writer = w.release();
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_writer_add_item(pod_writer_t* writer, const char* key, const void* srcValueArray, uint32_t valueCount, pod_type_t valueType, pod_filter_t filter)
+{
+    return pod_writer_add_item_ex(writer, key, srcValueArray, valueCount, valueType, filter);
+}
+
+pod_result_t pod_writer_add_item_ex(pod_writer_t* writer, const char* key, const void* srcValueArray, size_t valueCount, pod_type_t valueType, pod_filter_t filter)
+{
+    if ((writer == nullptr) || (key == nullptr) || (srcValueArray == nullptr && valueCount != 0))
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    if (writer->result != POD_SUCCESS)
+    {
+        return writer->result;
+    }
+
+    pod_type_t type;
+
+    if (!to_pod_type(valueType, type))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    if (valueCount > MaxCountLookup[size_of_type(type)])
+    {
+        return POD_OUT_OF_RANGE;
+    }
+
+    // the header is already written, so the file can't switch to 64-bit counts
+    if ((valueCount > cMaxCount32) && ((writer->header.flags & POD_FLAGS_COUNT64) == 0))
+    {
+        return POD_OUT_OF_RANGE;
+    }
+
+    if (!is_valid_filter(filter))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    // Every key can only be written once
+
+    auto inserted = writer->keys.emplace(key);
+
+    if (!inserted.second)
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    // The values are read in place
+
+    PodData data;
+    data.count = valueCount;
+    data.type = type;
+    data.filter = filter;
+    data.mapped = static_cast<const uint8_t*>(srcValueArray);
+
+    if (requires_byte_swap(writer->header.endian))
+    {
+        writer->result = writeItem<true>(*writer, *inserted.first, data);
+    }
+    else
+    {
+        writer->result = writeItem<false>(*writer, *inserted.first, data);
+    }
+
+    // writes behind the caller may fail later, which the next call or pod_writer_close returns
+
+    if ((writer->result == POD_SUCCESS) && writer->file.failed())
+    {
+        writer->result = POD_FILE_NOT_FOUND;
+    }
+
+    return writer->result;
+}
+
+pod_result_t pod_writer_close(pod_writer_t* writer)
+{
+    if (writer == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    std::unique_ptr<pod_writer_t> w(writer);
+
+    if (w->result != POD_SUCCESS)
+    {
+        // release the codec and its threads, the file is incomplete anyway
+        deflate_end(w->cs);
+        return w->result;
+    }
+
+    std::vector<PodIndexEntry> kept;
+
+    if (requires_byte_swap(w->header.endian))
+    {
+        return write_trailer<true>(w->file, w->header, w->cs, w->index, w->bodyOffset, kept, w->buffer);
+    }
+    else
+    {
+        return write_trailer<false>(w->file, w->header, w->cs, w->index, w->bodyOffset, kept, w->buffer);
+    }
+}
@@ -0,0 +1,100 @@
+// pod-io
+// Kyle J Burgess
+
+#ifndef POD_WRITER_H
+#define POD_WRITER_H
+
+#include "pod_io.h"
+#include "PodBytes.h"
+#include "PodChecksum.h"
+#include "PodDeflate.h"
+#include "PodFile.h"
+#include "PodHeader.h"
+#include "PodIndex.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// A file that items are written to one at a time (see pod_writer_open)
+struct pod_writer_t
+{
+    explicit pod_writer_t(const char* fileName)
+        : file(fileName, FM_WRITE)
+        , header()
+        , cs()
+        , bodyOffset(0)
+        , result(POD_SUCCESS)
+    {}
+
+    File file;                              // file being written
+    PodHeader header;                       // header of the file
+    compress_stream cs;                     // stream that the blocks are deflated into
+    uint64_t bodyOffset;                    // offset of the first block
+    std::vector<PodIndexEntry> index;       // index entries of the written blocks (POD_FLAGS_INDEX only)
+    std::unordered_set<std::string> keys;   // keys of the written blocks
+    std::vector<uint8_t> buffer;            // temporary buffer used for deflating
+    pod_result_t result;                    // first error, returned by every later call
+};
+
+// Finish the deflate stream of a body that starts at bodyOffset,
+// then write the index (if the file has one) and the trailing checksum
+// index holds an entry for every block in the stream, in order, and their offsets are filled in
+// along with their sizes and checksums if the file has POD_FLAGS_BLOCK_CHECKSUM
+// kept are index entries of blocks already in the file (see pod_append_file)
+// returns POD_SUCCESS on success,
+// POD_ZLIB_ERROR if the stream can't be finished,
+// and POD_FILE_NOT_FOUND if a write to the file has failed
+template<bool reverse_bytes>
+pod_result_t write_trailer(File& file, const PodHeader& header, compress_stream& cs, std::vector<PodIndexEntry>& index, uint64_t bodyOffset, const std::vector<PodIndexEntry>& kept, std::vector<uint8_t>& buffer)
+{
+    if (deflate_end(cs) != COMPRESS_SUCCESS)
+    {
+        return POD_ZLIB_ERROR;
+    }
+
+    uint32_t check32 = cs.check32;
+
+    // Write index
+    if ((header.flags & POD_FLAGS_INDEX) != 0)
+    {
+        for (size_t i = 1; i < index.size(); ++i)
+        {
+            index[i].offset = cs.flushes[i - 1];
+        }
+
+        for (auto& entry : index)
+        {
+            entry.offset += bodyOffset;
+        }
+
+        // every block ends at its flush point
+
+        if ((header.flags & POD_FLAGS_BLOCK_CHECKSUM) != 0)
+        {
+            for (size_t i = 0; i != index.size(); ++i)
+            {
+                index[i].size = cs.flushes[i] + bodyOffset - index[i].offset;
+                index[i].check32 = cs.flush_checks[i];
+            }
+        }
+
+        index.insert(index.end(), kept.begin(), kept.end());
+
+        encode_index<reverse_bytes>(buffer, index, file.tell(), header.flags);
+        file.write(buffer.data(), buffer.size());
+        check32 = checksum_update(header.checksum, check32, buffer.data(), buffer.size());
+    }
+
+    // Write checksum
+    if (header.checksum != POD_CHECKSUM_NONE)
+    {
+        buffer.resize(4);
+        set_bytes<uint32_t, reverse_bytes>(buffer, check32, 0, 4);
+        file.write(buffer.data(), buffer.size());
+    }
+
+    return file.flush() ? POD_SUCCESS : POD_FILE_NOT_FOUND;
+}
+
+#endif
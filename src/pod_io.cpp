@@ -5,8 +5,14 @@
 #include "PodBytes.h"
 #include "PodTypes.h"
 #include "PodLookup.h"
+#include "PodLazy.h"
+#include "PodFilter.h"
 
+#include <cstring>
+#include <limits>
+#include <new>
 #include <stdexcept>
+#include <string_view>
 
 pod_container_t* pod_alloc()
 {
@@ -18,46 +24,44 @@ void pod_free(pod_container_t* container)
     delete container;
 }
 
-pod_item_t* pod_get_item(pod_container_t* container, const char* key)
+pod_result_t pod_reserve(pod_container_t* container, size_t itemCount)
 {
     if (container == nullptr)
     {
-        return nullptr;
+        return POD_NULL_REFERENCE;
     }
 
-    std::string str;
-
-    try
+    return catch_alloc([&]()
     {
-        str.assign(key);
-    }
-    catch (const std::length_error&)
+        container->map.reserve(itemCount);
+        return POD_SUCCESS;
+    });
+}
+
+pod_item_t* pod_get_item(pod_container_t* container, const char* key)
+{
+    if (key == nullptr)
     {
         return nullptr;
     }
 
-    // limit key size
-    if (str.size() > std::numeric_limits<uint32_t>::max())
+    return pod_get_item_n(container, key, strlen(key));
+}
+
+pod_item_t* pod_get_item_n(pod_container_t* container, const char* key, size_t keySize)
+{
+    if ((container == nullptr) || ((key == nullptr) && (keySize != 0)))
     {
         return nullptr;
     }
 
-    auto& map = container->map;
-
-    auto it = map.find(key);
-
-    if (it == map.end())
+    // limit key size
+    if (keySize > std::numeric_limits<uint32_t>::max())
     {
-        const PodData data =
-            {
-                .count = 0,
-                .type = POD_UINT8,
-            };
-
-        it = map.insert(std::make_pair(std::move(str), data)).first;
+        return nullptr;
     }
 
-    return reinterpret_cast<pod_item_t*>(&(*it));
+    return reinterpret_cast<pod_item_t*>(&container->map.insert(std::string_view(key, keySize)));
 }
 
 pod_result_t pod_remove_item(pod_container_t* container, pod_item_t* item)
@@ -67,84 +71,191 @@ pod_result_t pod_remove_item(pod_container_t* container, pod_item_t* item)
         return POD_NULL_REFERENCE;
     }
 
-    auto& key = reinterpret_cast<const std::pair<std::string,PodData>*>(item)->first;
-
-    container->map.erase(key);
+    container->map.erase(*reinterpret_cast<PodItem*>(item));
 
     return POD_SUCCESS;
 }
 
 pod_item_t* pod_try_get_item(pod_container_t* container, const char* key)
 {
-    if (container == nullptr)
+    if (key == nullptr)
     {
         return nullptr;
     }
 
-    std::string str;
+    return pod_try_get_item_n(container, key, strlen(key));
+}
 
-    try
+pod_item_t* pod_try_get_item_n(pod_container_t* container, const char* key, size_t keySize)
+{
+    if ((container == nullptr) || ((key == nullptr) && (keySize != 0)))
     {
-        str.assign(key);
+        return nullptr;
     }
-    catch (const std::length_error&)
+
+    return reinterpret_cast<pod_item_t*>(container->map.find(std::string_view(key, keySize)));
+}
+
+pod_key_t* pod_intern_key(const char* key, size_t keySize)
+{
+    if (((key == nullptr) && (keySize != 0)) || (keySize > std::numeric_limits<uint32_t>::max()))
     {
         return nullptr;
     }
 
-    // limit key size
-    if (str.size() > std::numeric_limits<uint32_t>::max())
+    std::string_view view(key, keySize);
+
+    return new pod_key_t { std::string(view), PodMap::hashOf(view) };
+}
+
+void pod_free_key(pod_key_t* key)
+{
+    delete key;
+}
+
+pod_item_t* pod_get_item_key(pod_container_t* container, const pod_key_t* key)
+{
+    if ((container == nullptr) || (key == nullptr))
     {
         return nullptr;
     }
 
-    auto& map = container->map;
-
-    auto it = map.find(key);
+    return reinterpret_cast<pod_item_t*>(&container->map.insert(key->key, key->hash));
+}
 
-    if (it == map.end())
+pod_item_t* pod_try_get_item_key(pod_container_t* container, const pod_key_t* key)
+{
+    if ((container == nullptr) || (key == nullptr))
     {
         return nullptr;
     }
 
-    return reinterpret_cast<pod_item_t*>(&(*it));
+    return reinterpret_cast<pod_item_t*>(container->map.find(key->key, key->hash));
 }
 
 pod_result_t pod_set_values(pod_item_t* item, const void* srcValueArray, uint32_t valueCount, pod_type_t valueType)
+{
+    return pod_set_values_ex(item, srcValueArray, valueCount, valueType);
+}
+
+pod_result_t pod_set_values_ex(pod_item_t* item, const void* srcValueArray, size_t valueCount, pod_type_t valueType)
 {
     if (item == nullptr)
     {
         return POD_NULL_REFERENCE;
     }
 
-    uint32_t maxCount = MaxCountLookup[size_of_type(valueType)];
+    size_t maxCount = MaxCountLookup[size_of_type(valueType)];
 
     if (valueCount > maxCount)
     {
         return POD_OUT_OF_RANGE;
     }
 
-    size_t size = static_cast<size_t>(valueCount) * size_of_type(valueType);
+    size_t size = valueCount * size_of_type(valueType);
+
+    auto& data = reinterpret_cast<PodItem*>(item)->data;
+
+    // the item is left as it was if the values can't be allocated
+
+    uint8_t* values = nullptr;
 
-    auto& data = reinterpret_cast<std::pair<std::string,PodData>*>(item)->second;
+    pod_result_t result = catch_alloc([&]()
+    {
+        values = data.values.allocate(size);
+        return POD_SUCCESS;
+    });
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
 
-    data.values.resize(size);
     data.count = valueCount;
     data.type = valueType;
+    data.release();
+    data.dirty = true;
+
+    memcpy(values, srcValueArray, size);
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_set_filter(pod_item_t* item, pod_filter_t filter)
+{
+    if (item == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    if (!is_valid_filter(filter))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    auto& data = reinterpret_cast<PodItem*>(item)->data;
+
+    // the cached block was compressed with the old filter
+
+    if (data.filter != filter)
+    {
+        data.filter = filter;
+        data.dirty = true;
+        data.cache = PodBlockCache();
+    }
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_try_get_filter(const pod_item_t* item, pod_filter_t* filter)
+{
+    if (item == nullptr)
+    {
+        return POD_NULL_REFERENCE;
+    }
 
-    memcpy(data.values.data(), srcValueArray, size);
+    auto& data = reinterpret_cast<const PodItem*>(item)->data;
+
+    if (filter != nullptr)
+    {
+        *filter = static_cast<pod_filter_t>(data.filter);
+    }
 
     return POD_SUCCESS;
 }
 
 pod_result_t pod_try_count_values(const pod_item_t* item, uint32_t* valueCount)
+{
+    size_t count;
+
+    pod_result_t result = pod_try_count_values_ex(item, &count);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    if (count > cMaxCount32)
+    {
+        return POD_OUT_OF_RANGE;
+    }
+
+    if (valueCount != nullptr)
+    {
+        *valueCount = static_cast<uint32_t>(count);
+    }
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_try_count_values_ex(const pod_item_t* item, size_t* valueCount)
 {
     if (item == nullptr)
     {
         return POD_NULL_REFERENCE;
     }
 
-    auto& data = reinterpret_cast<const std::pair<std::string,PodData>*>(item)->second;
+    auto& data = reinterpret_cast<const PodItem*>(item)->data;
 
     if (valueCount != nullptr)
     {
@@ -161,7 +272,7 @@ pod_result_t pod_try_get_type(const pod_item_t* item, pod_type_t* valueType)
         return POD_NULL_REFERENCE;
     }
 
-    auto& data = reinterpret_cast<const std::pair<std::string,PodData>*>(item)->second;
+    auto& data = reinterpret_cast<const PodItem*>(item)->data;
 
     if (valueType != nullptr)
     {
@@ -172,13 +283,18 @@ pod_result_t pod_try_get_type(const pod_item_t* item, pod_type_t* valueType)
 }
 
 pod_result_t pod_try_copy_values(const pod_item_t* item, void* dstValueArray, uint32_t valueCount, pod_type_t type)
+{
+    return pod_try_copy_values_ex(item, dstValueArray, valueCount, type);
+}
+
+pod_result_t pod_try_copy_values_ex(const pod_item_t* item, void* dstValueArray, size_t valueCount, pod_type_t type)
 {
     if (item == nullptr)
     {
         return POD_NULL_REFERENCE;
     }
 
-    auto& data = reinterpret_cast<const std::pair<std::string,PodData>*>(item)->second;
+    auto& data = reinterpret_cast<const PodItem*>(item)->data;
 
     if (data.count == 0)
     {
@@ -190,13 +306,53 @@ pod_result_t pod_try_copy_values(const pod_item_t* item, void* dstValueArray, ui
         return POD_TYPE_MISMATCH;
     }
 
-    size_t size = valueCount * size_of_type(type);
-    if (size > data.values.size())
+    if (valueCount > data.count)
     {
         return POD_OUT_OF_RANGE;
     }
 
-    memcpy(dstValueArray, data.values.data(), size);
+    pod_result_t result = load_values(data);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    size_t size = valueCount * size_of_type(type);
+
+    memcpy(dstValueArray, data.data(), size);
+
+    return POD_SUCCESS;
+}
+
+pod_result_t pod_try_get_values(const pod_item_t* item, const void** values, pod_type_t type)
+{
+    if ((item == nullptr) || (values == nullptr))
+    {
+        return POD_NULL_REFERENCE;
+    }
+
+    auto& data = reinterpret_cast<const PodItem*>(item)->data;
+
+    if (data.count == 0)
+    {
+        *values = nullptr;
+        return POD_SUCCESS;
+    }
+
+    if (type != data.type)
+    {
+        return POD_TYPE_MISMATCH;
+    }
+
+    pod_result_t result = load_values(data);
+
+    if (result != POD_SUCCESS)
+    {
+        return result;
+    }
+
+    *values = data.data();
 
     return POD_SUCCESS;
 }
@@ -208,7 +364,7 @@ pod_result_t pod_try_count_key_chars(const pod_item_t* item, uint32_t* count)
         return POD_NULL_REFERENCE;
     }
 
-    auto& key = reinterpret_cast<const std::pair<std::string,PodData>*>(item)->first;
+    auto& key = reinterpret_cast<const PodItem*>(item)->key;
 
     if (count != nullptr)
     {
@@ -225,7 +381,7 @@ pod_result_t pod_try_copy_key(const pod_item_t* item, char* buffer, uint32_t cha
         return POD_NULL_REFERENCE;
     }
 
-    auto& key = reinterpret_cast<const std::pair<std::string,PodData>*>(item)->first;
+    auto& key = reinterpret_cast<const PodItem*>(item)->key;
 
     if (charCount != key.size())
     {
@@ -244,16 +400,7 @@ pod_item_t* pod_get_first_item(pod_container_t* container)
         return nullptr;
     }
 
-    auto& map = container->map;
-
-    auto it = map.begin();
-
-    if (it == map.end())
-    {
-        return nullptr;
-    }
-
-    return reinterpret_cast<pod_item_t*>(&(*it));
+    return reinterpret_cast<pod_item_t*>(container->map.first());
 }
 
 pod_item_t* pod_get_next_item(pod_container_t* container, pod_item_t* item)
@@ -263,16 +410,5 @@ pod_item_t* pod_get_next_item(pod_container_t* container, pod_item_t* item)
         return nullptr;
     }
 
-    auto& key = reinterpret_cast<const std::pair<std::string,PodData>*>(item)->first;
-
-    auto& map = container->map;
-
-    auto it = map.find(key);
-
-    if (it == map.end())
-    {
-        return nullptr;
-    }
-
-    return reinterpret_cast<pod_item_t*>(&(*it));
+    return reinterpret_cast<pod_item_t*>(reinterpret_cast<const PodItem*>(item)->next);
 }
@@ -68,7 +68,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     auto block = pod_get_item(container, "test string");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "2\n";
         return false;
@@ -82,7 +82,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "UKeyA");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "4\n";
         return false;
@@ -96,7 +96,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "UKeyB");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "6\n";
         return false;
@@ -110,7 +110,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "UKeyC");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "8\n";
         return false;
@@ -124,7 +124,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "UKeyD");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "9\n";
         return false;
@@ -138,7 +138,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "KeyE");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "11\n";
         return false;
@@ -152,7 +152,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "KeyF");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "13\n";
         return false;
@@ -166,7 +166,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "KeyG");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "15\n";
         return false;
@@ -180,7 +180,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "KeyH");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "17\n";
         return false;
@@ -194,7 +194,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "FloatKeyI");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "19\n";
         return false;
@@ -208,7 +208,7 @@ bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t che
     }
 
     block = pod_get_item(container, "DoubleKeyJ");
-    if (pod_try_count_values(block, count) != POD_SUCCESS)
+    if (pod_try_count_values(block, &count) != POD_SUCCESS)
     {
         std::cout << "21\n";
         return false;
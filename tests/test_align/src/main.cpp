@@ -0,0 +1,244 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const char* fileName = "align_file.test.bin";
+
+std::vector<uint8_t> u8(13);
+std::vector<int16_t> i16(1001);
+std::vector<double> f64(77);
+std::vector<uint32_t> u32(64);
+
+void init()
+{
+    for (size_t i = 0; i != u8.size(); ++i)
+    {
+        u8[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    for (size_t i = 0; i != i16.size(); ++i)
+    {
+        i16[i] = static_cast<int16_t>(i * 3);
+    }
+
+    for (size_t i = 0; i != f64.size(); ++i)
+    {
+        f64[i] = static_cast<double>(i) * 0.25;
+    }
+
+    for (size_t i = 0; i != u32.size(); ++i)
+    {
+        u32[i] = static_cast<uint32_t>(i) * 2654435761u;
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    auto item = pod_try_get_item(container, key);
+
+    size_t count;
+
+    if ((pod_try_count_values_ex(item, &count) != POD_SUCCESS) || (count != values.size()))
+    {
+        return false;
+    }
+
+    std::vector<T> copy(values.size());
+
+    return
+        (pod_try_copy_values_ex(item, copy.data(), copy.size(), type) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values.data(), values.size() * sizeof(T)) == 0);
+}
+
+bool check(pod_container_t* container)
+{
+    return
+        check_item(container, "u8", u8, POD_UINT8) &&
+        check_item(container, "key_i16", i16, POD_INT16) &&
+        check_item(container, "a_longer_key_f64", f64, POD_FLOAT64) &&
+        check_item(container, "a_key_that_is_longer_than_the_alignment_of_a_block_u32", u32, POD_UINT32);
+}
+
+// Every mapped item points at 64 byte aligned values
+bool check_aligned(pod_container_t* container, const char* key, pod_type_t type)
+{
+    const void* values;
+
+    if (pod_try_get_values(pod_try_get_item(container, key), &values, type) != POD_SUCCESS)
+    {
+        return false;
+    }
+
+    return (reinterpret_cast<uintptr_t>(values) % 64) == 0;
+}
+
+bool check_mapped(pod_container_t* container)
+{
+    return
+        check(container) &&
+        check_aligned(container, "u8", POD_UINT8) &&
+        check_aligned(container, "key_i16", POD_INT16) &&
+        check_aligned(container, "a_longer_key_f64", POD_FLOAT64) &&
+        check_aligned(container, "a_key_that_is_longer_than_the_alignment_of_a_block_u32", POD_UINT32);
+}
+
+bool test(pod_container_t* src, pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_flags_t flags)
+{
+    flags = static_cast<pod_flags_t>(flags | POD_FLAGS_ALIGN);
+
+    if (pod_save_file_ex(src, fileName, compression, codec, POD_CHECKSUM_CRC32, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return false;
+    }
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    if ((pod_map_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to map file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if ((flags & POD_FLAGS_INDEX) != 0)
+    {
+        container = pod_alloc();
+
+        if ((pod_load_file_lazy(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+        {
+            std::cout << "failed to load lazily\n";
+            return false;
+        }
+
+        pod_free(container);
+    }
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    auto src = pod_alloc();
+
+    if ((pod_set_values(pod_get_item(src, "u8"), u8.data(), u8.size(), POD_UINT8) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "key_i16"), i16.data(), i16.size(), POD_INT16) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "a_longer_key_f64"), f64.data(), f64.size(), POD_FLOAT64) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "a_key_that_is_longer_than_the_alignment_of_a_block_u32"), u32.data(), u32.size(), POD_UINT32) != POD_SUCCESS) ||
+        (pod_set_filter(pod_get_item(src, "key_i16"), POD_FILTER_DELTA) != POD_SUCCESS))
+    {
+        std::cout << "failed to set values\n";
+        return -1;
+    }
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_FILTER), POD_FLAGS_APPEND, POD_FLAGS_COUNT64 };
+
+    for (uint32_t threads : { 1u, 2u })
+    {
+        pod_set_thread_count(threads);
+
+        for (auto level : levels)
+        {
+            for (auto codec : codecs)
+            {
+                for (auto endian : endians)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(src, level, codec, endian, flag))
+                        {
+                            std::cout << "threads " << threads << ", level " << level << ", codec " << codec << ", endian " << endian << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Mapped values of uncompressed files are aligned
+
+    const pod_flags_t mappedFlags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX, POD_FLAGS_COUNT64, POD_FLAGS_APPEND };
+
+    for (auto flag : mappedFlags)
+    {
+        flag = static_cast<pod_flags_t>(flag | POD_FLAGS_ALIGN);
+
+        if (pod_save_file_ex(src, fileName, POD_COMPRESSION_0, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, flag) != POD_SUCCESS)
+        {
+            std::cout << "failed to save file\n";
+            return -1;
+        }
+
+        auto container = pod_alloc();
+
+        if ((pod_map_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check_mapped(container))
+        {
+            std::cout << "mapped values aren't aligned, flags " << flag << "\n";
+            return -1;
+        }
+
+        pod_free(container);
+    }
+
+    // Appended segments of the last file stay aligned
+
+    auto update = pod_alloc();
+
+    if ((pod_set_values(pod_get_item(update, "u8"), u8.data(), u8.size(), POD_UINT8) != POD_SUCCESS) ||
+        (pod_append_file(update, fileName, POD_COMPRESSION_0, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS))
+    {
+        std::cout << "failed to append file\n";
+        return -1;
+    }
+
+    auto container = pod_alloc();
+
+    if ((pod_map_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check_mapped(container))
+    {
+        std::cout << "appended values aren't aligned\n";
+        return -1;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load appended file\n";
+        return -1;
+    }
+
+    pod_free(container);
+    pod_free(update);
+    pod_free(src);
+
+    std::remove(fileName);
+
+    return 0;
+}
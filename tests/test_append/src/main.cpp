@@ -0,0 +1,365 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+const char* fileName = "append_file.test.bin";
+
+std::vector<int32_t> a(20011);
+std::vector<double> b(5003);
+std::vector<double> b2(7001);
+std::vector<uint16_t> c(3);
+std::vector<float> d(10007);
+
+void init()
+{
+    for (size_t i = 0; i != a.size(); ++i)
+    {
+        a[i] = static_cast<int32_t>(i * 3) - 1000;
+    }
+
+    for (size_t i = 0; i != b.size(); ++i)
+    {
+        b[i] = 1000.0 + static_cast<double>(i) * 0.125;
+    }
+
+    for (size_t i = 0; i != b2.size(); ++i)
+    {
+        b2[i] = -static_cast<double>(i) * 0.5;
+    }
+
+    for (size_t i = 0; i != c.size(); ++i)
+    {
+        c[i] = static_cast<uint16_t>(0x1234u * (i + 1));
+    }
+
+    for (size_t i = 0; i != d.size(); ++i)
+    {
+        d[i] = static_cast<float>(i % 97) * 0.25f;
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    auto item = pod_try_get_item(container, key);
+
+    if (item == nullptr)
+    {
+        return false;
+    }
+
+    uint32_t count;
+    if ((pod_try_count_values(item, &count) != POD_SUCCESS) || (count != values.size()))
+    {
+        return false;
+    }
+
+    std::vector<T> copy(count);
+
+    if (pod_try_copy_values(item, copy.data(), count, type) != POD_SUCCESS)
+    {
+        return false;
+    }
+
+    return memcmp(copy.data(), values.data(), count * sizeof(T)) == 0;
+}
+
+// Check the items of the file after b is replaced and d is appended
+bool check(pod_container_t* container)
+{
+    return
+        check_item(container, "a", a, POD_INT32) &&
+        check_item(container, "b", b2, POD_FLOAT64) &&
+        check_item(container, "c", c, POD_UINT16) &&
+        check_item(container, "d", d, POD_FLOAT32);
+}
+
+long file_size()
+{
+    FILE* file = fopen(fileName, "rb");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+bool save(pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, pod_endian_t endian, pod_flags_t flags)
+{
+    auto container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "a"), a.data(), a.size(), POD_INT32);
+    pod_set_values(pod_get_item(container, "b"), b.data(), b.size(), POD_FLOAT64);
+    pod_set_values(pod_get_item(container, "c"), c.data(), c.size(), POD_UINT16);
+
+    pod_result_t result = pod_save_file_ex(container, fileName, compression, codec, checksum, 0, endian, flags);
+
+    pod_free(container);
+
+    return result == POD_SUCCESS;
+}
+
+bool append(pod_compression_t compression, pod_checksum_t checksum)
+{
+    // each item is appended in its own segment
+    auto container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "b"), b2.data(), b2.size(), POD_FLOAT64);
+
+    pod_result_t result = pod_append_file(container, fileName, compression, checksum, 0);
+
+    pod_free(container);
+
+    if (result != POD_SUCCESS)
+    {
+        return false;
+    }
+
+    container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "d"), d.data(), d.size(), POD_FLOAT32);
+
+    result = pod_append_file(container, fileName, compression, checksum, 0);
+
+    pod_free(container);
+
+    return result == POD_SUCCESS;
+}
+
+bool test_load(pod_checksum_t checksum)
+{
+    for (uint32_t threads : { 1u, 2u })
+    {
+        pod_set_thread_count(threads);
+
+        auto container = pod_alloc();
+
+        if ((pod_load_file(container, fileName, checksum, 0) != POD_SUCCESS) || !check(container))
+        {
+            std::cout << "failed to load file with " << threads << " threads\n";
+            return false;
+        }
+
+        pod_free(container);
+    }
+
+    pod_set_thread_count(1);
+
+    auto container = pod_alloc();
+
+    if ((pod_map_file(container, fileName, checksum, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to map file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    if ((pod_load_file_lazy(container, fileName, checksum, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load lazily\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    const char* keys[] = { "a", "b", "c", "d" };
+
+    container = pod_alloc();
+
+    if ((pod_load_items(container, fileName, checksum, 0, keys, 4) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load items\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+bool test(pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, pod_endian_t endian, pod_flags_t flags)
+{
+    if (!save(compression, codec, checksum, endian, flags))
+    {
+        std::cout << "failed to save\n";
+        return false;
+    }
+
+    if (!append(compression, checksum))
+    {
+        std::cout << "failed to append\n";
+        return false;
+    }
+
+    if (!test_load(checksum))
+    {
+        return false;
+    }
+
+    // Compacting drops the replaced block of b
+
+    long appendedSize = file_size();
+
+    if (pod_compact_file(fileName, compression, checksum, 0) != POD_SUCCESS)
+    {
+        std::cout << "failed to compact\n";
+        return false;
+    }
+
+    if (file_size() >= appendedSize)
+    {
+        std::cout << "compacting didn't reduce the file size\n";
+        return false;
+    }
+
+    return test_load(checksum);
+}
+
+int main()
+{
+    init();
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_1, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_ADLER32, POD_CHECKSUM_CRC32 };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_APPEND, static_cast<pod_flags_t>(POD_FLAGS_APPEND | POD_FLAGS_FILTER) };
+
+    for (auto level : levels)
+    {
+        for (auto codec : codecs)
+        {
+            for (auto checksum : checksums)
+            {
+                for (auto endian : endians)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(level, codec, checksum, endian, flag))
+                        {
+                            std::cout << "level " << level << ", codec " << codec << ", checksum " << checksum << ", endian " << endian << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Corrupt blocks fail the checksum of every segment
+
+    if (!save(POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, POD_ENDIAN_NATIVE, POD_FLAGS_APPEND) ||
+        !append(POD_COMPRESSION_DEFAULT, POD_CHECKSUM_CRC32))
+    {
+        return -1;
+    }
+
+    {
+        FILE* file = fopen(fileName, "r+b");
+        fseek(file, 40, SEEK_SET);
+        int byte = fgetc(file);
+        fseek(file, 40, SEEK_SET);
+        fputc(byte ^ 0xFF, file);
+        fclose(file);
+    }
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_FILE_CORRUPT) ||
+        (pod_compact_file(fileName, POD_COMPRESSION_DEFAULT, POD_CHECKSUM_CRC32, 0) != POD_FILE_CORRUPT))
+    {
+        std::cout << "accepted a corrupt file\n";
+        return -1;
+    }
+
+    pod_free(container);
+
+#ifdef __linux__
+    // Writes past the file size limit fail, compacting keeps the original file and appending returns the error
+
+    if (!save(POD_COMPRESSION_0, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, POD_ENDIAN_NATIVE, POD_FLAGS_APPEND) ||
+        !append(POD_COMPRESSION_0, POD_CHECKSUM_CRC32))
+    {
+        return -1;
+    }
+
+    signal(SIGXFSZ, SIG_IGN);
+
+    rlimit limit;
+    getrlimit(RLIMIT_FSIZE, &limit);
+
+    rlimit small = limit;
+    small.rlim_cur = static_cast<rlim_t>(file_size() / 2);
+    setrlimit(RLIMIT_FSIZE, &small);
+
+    pod_result_t compacted = pod_compact_file(fileName, POD_COMPRESSION_0, POD_CHECKSUM_CRC32, 0);
+    pod_result_t verified = pod_verify_file(fileName, POD_CHECKSUM_CRC32, 0);
+
+    small.rlim_cur = static_cast<rlim_t>(file_size());
+    setrlimit(RLIMIT_FSIZE, &small);
+
+    container = pod_alloc();
+    pod_set_values(pod_get_item(container, "e"), d.data(), d.size(), POD_FLOAT32);
+
+    pod_result_t appended = pod_append_file(container, fileName, POD_COMPRESSION_0, POD_CHECKSUM_CRC32, 0);
+
+    pod_free(container);
+
+    setrlimit(RLIMIT_FSIZE, &limit);
+
+    if ((compacted != POD_FILE_NOT_FOUND) || (verified != POD_SUCCESS))
+    {
+        std::cout << "compacted a file that couldn't be written\n";
+        return -1;
+    }
+
+    if (appended != POD_FILE_NOT_FOUND)
+    {
+        std::cout << "appended to a file that couldn't be written\n";
+        return -1;
+    }
+
+    std::string tmpName = std::string(fileName) + ".tmp";
+
+    if (fopen(tmpName.c_str(), "rb") != nullptr)
+    {
+        std::cout << "left the temporary file of a failed compaction\n";
+        return -1;
+    }
+#endif
+
+    // Only files saved with POD_FLAGS_APPEND can be appended to
+
+    if (!save(POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, POD_ENDIAN_NATIVE, POD_FLAGS_INDEX))
+    {
+        return -1;
+    }
+
+    container = pod_alloc();
+
+    if (pod_append_file(container, fileName, POD_COMPRESSION_DEFAULT, POD_CHECKSUM_CRC32, 0) != POD_ARGUMENT_ERROR)
+    {
+        std::cout << "appended to a file without POD_FLAGS_APPEND\n";
+        return -1;
+    }
+
+    pod_free(container);
+
+    std::remove(fileName);
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+const char* fileName = "async_file.test.bin";
+
+std::vector<uint32_t> a(200003);
+std::vector<uint16_t> b(50021);
+std::vector<uint32_t> c(1000);
+
+void init()
+{
+    for (size_t i = 0; i != a.size(); ++i)
+    {
+        a[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+
+    for (size_t i = 0; i != b.size(); ++i)
+    {
+        b[i] = static_cast<uint16_t>(i * 7);
+    }
+
+    for (size_t i = 0; i != c.size(); ++i)
+    {
+        c[i] = static_cast<uint32_t>(i) ^ 0xFFFFu;
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    auto item = pod_try_get_item(container, key);
+
+    uint32_t count;
+
+    if ((pod_try_count_values(item, &count) != POD_SUCCESS) || (count != values.size()))
+    {
+        return false;
+    }
+
+    std::vector<T> copy(values.size());
+
+    return
+        (pod_try_copy_values(item, copy.data(), copy.size(), type) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values.data(), values.size() * sizeof(T)) == 0);
+}
+
+bool check_file(pod_flags_t flags)
+{
+    auto container = pod_alloc();
+
+    bool loaded =
+        (pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) == POD_SUCCESS) &&
+        check_item(container, "a", a, POD_UINT32) &&
+        check_item(container, "b", b, POD_UINT16);
+
+    pod_free(container);
+
+    if (!loaded)
+    {
+        std::cout << "failed to load file, flags " << flags << "\n";
+    }
+
+    return loaded;
+}
+
+const void* values_of(pod_container_t* container, const char* key, pod_type_t type)
+{
+    const void* values = nullptr;
+    pod_try_get_values(pod_try_get_item(container, key), &values, type);
+    return values;
+}
+
+int main()
+{
+    init();
+
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX, POD_FLAGS_APPEND };
+
+    for (auto flag : flags)
+    {
+        auto container = pod_alloc();
+
+        if ((pod_set_values(pod_get_item(container, "a"), a.data(), a.size(), POD_UINT32) != POD_SUCCESS) ||
+            (pod_set_values(pod_get_item(container, "b"), b.data(), b.size(), POD_UINT16) != POD_SUCCESS))
+        {
+            std::cout << "failed to set values\n";
+            return -1;
+        }
+
+        const void* valuesA = values_of(container, "a", POD_UINT32);
+
+        pod_save_t* save;
+
+        if (pod_save_file_async(&save, container, fileName, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, flag) != POD_SUCCESS)
+        {
+            std::cout << "failed to start save\n";
+            return -1;
+        }
+
+        // Changes made while the file is written aren't saved
+
+        if ((pod_set_values(pod_get_item(container, "a"), c.data(), c.size(), POD_UINT32) != POD_SUCCESS) ||
+            (pod_set_values(pod_get_item(container, "c"), c.data(), c.size(), POD_UINT32) != POD_SUCCESS) ||
+            (pod_remove_item(container, pod_try_get_item(container, "b")) != POD_SUCCESS))
+        {
+            std::cout << "failed to change container\n";
+            return -1;
+        }
+
+        // Items that were set got new values, instead of writing to the values being saved
+
+        if (values_of(container, "a", POD_UINT32) == valuesA)
+        {
+            std::cout << "set values of a shared item in place\n";
+            return -1;
+        }
+
+        uint32_t finished = 0;
+
+        while (finished == 0)
+        {
+            if (pod_save_poll(save, &finished) != POD_SUCCESS)
+            {
+                std::cout << "failed to poll save\n";
+                return -1;
+            }
+
+            std::this_thread::yield();
+        }
+
+        if (pod_save_wait(save) != POD_SUCCESS)
+        {
+            std::cout << "failed to save file, flags " << flag << "\n";
+            return -1;
+        }
+
+        if (!check_file(flag) || !check_item(container, "a", c, POD_UINT32) || !check_item(container, "c", c, POD_UINT32))
+        {
+            return -1;
+        }
+
+        // Once the save is done, the values aren't shared, so they are set in place
+
+        const void* valuesC = values_of(container, "c", POD_UINT32);
+
+        if ((pod_set_values(pod_get_item(container, "c"), a.data(), c.size(), POD_UINT32) != POD_SUCCESS) ||
+            (values_of(container, "c", POD_UINT32) != valuesC))
+        {
+            std::cout << "copied values that weren't shared\n";
+            return -1;
+        }
+
+        // The container can be freed before the save is done
+
+        pod_free(container);
+        container = pod_alloc();
+
+        if ((pod_set_values(pod_get_item(container, "a"), a.data(), a.size(), POD_UINT32) != POD_SUCCESS) ||
+            (pod_set_values(pod_get_item(container, "b"), b.data(), b.size(), POD_UINT16) != POD_SUCCESS) ||
+            (pod_save_file_async(&save, container, fileName, POD_COMPRESSION_DEFAULT, POD_CODEC_LZ, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_BIG, flag) != POD_SUCCESS))
+        {
+            std::cout << "failed to start save\n";
+            return -1;
+        }
+
+        pod_free(container);
+
+        if ((pod_save_wait(save) != POD_SUCCESS) || !check_file(flag))
+        {
+            std::cout << "failed to save freed container, flags " << flag << "\n";
+            return -1;
+        }
+    }
+
+    // Errors are returned by pod_save_wait
+
+    auto container = pod_alloc();
+    pod_save_t* save;
+
+    if ((pod_save_file_async(&save, container, "missing_directory/async_file.test.bin", POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_NONE, 0, POD_ENDIAN_NATIVE, POD_FLAGS_NONE) != POD_SUCCESS) ||
+        (pod_save_wait(save) != POD_FILE_NOT_FOUND))
+    {
+        std::cout << "failed to return save error\n";
+        return -1;
+    }
+
+    pod_free(container);
+
+    std::remove(fileName);
+
+    return 0;
+}
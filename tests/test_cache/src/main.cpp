@@ -0,0 +1,161 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const char* fileName = "cache_file.test.bin";
+
+constexpr size_t cItemCount = 16;
+constexpr size_t cValueCount = 50000;
+
+// Values of item i after it has been set n times
+std::vector<uint32_t> values(size_t i, size_t n)
+{
+    std::vector<uint32_t> v(cValueCount);
+
+    for (size_t j = 0; j != v.size(); ++j)
+    {
+        v[j] = static_cast<uint32_t>((i + 1) * (j / 7) + n * 31);
+    }
+
+    return v;
+}
+
+std::string key(size_t i)
+{
+    return "item" + std::to_string(i);
+}
+
+void set(pod_container_t* container, size_t i, size_t n)
+{
+    auto v = values(i, n);
+    pod_set_values(pod_get_item(container, key(i).c_str()), v.data(), v.size(), POD_UINT32);
+}
+
+// versions[i] is the number of times item i has been set
+bool check(const std::vector<size_t>& versions, pod_checksum_t checksum)
+{
+    auto container = pod_alloc();
+
+    if (pod_load_file(container, fileName, checksum, 0) != POD_SUCCESS)
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    for (size_t i = 0; i != cItemCount; ++i)
+    {
+        auto v = values(i, versions[i]);
+        std::vector<uint32_t> copy(cValueCount);
+
+        if (pod_try_copy_values(pod_try_get_item(container, key(i).c_str()), copy.data(), cValueCount, POD_UINT32) != POD_SUCCESS ||
+            memcmp(copy.data(), v.data(), cValueCount * 4) != 0)
+        {
+            std::cout << "item " << i << " doesn't match\n";
+            return false;
+        }
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+bool test(pod_codec_t codec, pod_checksum_t checksum, pod_flags_t flags, uint32_t threads)
+{
+    pod_set_thread_count(threads);
+
+    auto container = pod_alloc();
+    std::vector<size_t> versions(cItemCount, 0);
+
+    for (size_t i = 0; i != cItemCount; ++i)
+    {
+        set(container, i, 0);
+        pod_set_filter(pod_get_item(container, key(i).c_str()), POD_FILTER_DELTA);
+    }
+
+    // Save repeatedly, changing a few items between saves
+    // and changing the options that the cached blocks depend on
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_6, POD_COMPRESSION_6, POD_COMPRESSION_1, POD_COMPRESSION_1, POD_COMPRESSION_6 };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_LITTLE, POD_ENDIAN_LITTLE, POD_ENDIAN_BIG, POD_ENDIAN_BIG };
+
+    for (size_t n = 0; n != 5; ++n)
+    {
+        if (n != 0)
+        {
+            size_t i = (n * 5) % cItemCount;
+            set(container, i, n);
+            versions[i] = n;
+        }
+
+        if (n == 2)
+        {
+            // a changed filter also changes the block
+            pod_set_filter(pod_get_item(container, key(3).c_str()), POD_FILTER_SHUFFLE);
+        }
+
+        if (pod_save_file_ex(container, fileName, levels[n], codec, checksum, 0, endians[n], flags) != POD_SUCCESS)
+        {
+            std::cout << "failed to save\n";
+            return false;
+        }
+
+        if (!check(versions, checksum))
+        {
+            std::cout << "save " << n << "\n";
+            return false;
+        }
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    pod_set_block_cache(1);
+
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_CRC32 };
+    const pod_flags_t flags[] = { POD_FLAGS_INDEX, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_FILTER) };
+
+    for (auto codec : codecs)
+    {
+        for (auto checksum : checksums)
+        {
+            for (auto flag : flags)
+            {
+                for (uint32_t threads : { 1u, 2u })
+                {
+                    if (!test(codec, checksum, flag, threads))
+                    {
+                        std::cout << "codec " << codec << ", checksum " << checksum << ", flags " << flag << ", threads " << threads << "\n";
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    // Without the cache every block is compressed again
+
+    pod_set_block_cache(0);
+
+    if (!test(POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, POD_FLAGS_INDEX, 1))
+    {
+        std::cout << "failed without the block cache\n";
+        return -1;
+    }
+
+    std::remove(fileName);
+
+    return 0;
+}
@@ -4,14 +4,35 @@
 #include "pod_io.h"
 #include "PodFile.h"
 #include "PodBytes.h"
+#include "PodChecksum.h"
+#include "PodThreadPool.h"
 #include "zlib.h"
 
+#include <cstdio>
 #include <vector>
 #include <cstring>
 #include <iostream>
 
 const char* fileName = "checksum_file.test.bin";
 
+// Bitwise CRC32C to check the table and hardware versions against
+uint32_t crc32c_reference(uint32_t crc, const uint8_t* data, size_t size)
+{
+    crc = ~crc;
+
+    for (size_t i = 0; i != size; ++i)
+    {
+        crc ^= data[i];
+
+        for (int bit = 0; bit != 8; ++bit)
+        {
+            crc = (crc & 1u) ? (crc >> 1) ^ 0x82F63B78u : (crc >> 1);
+        }
+    }
+
+    return ~crc;
+}
+
 template<pod_endian_t endian, pod_checksum_t checksum>
 bool testFile()
 {
@@ -28,7 +49,7 @@ bool testFile()
 
     while (true)
     {
-        size_t tmp = file.read(buffer.data(), 1024);
+        size_t tmp = file.read(buffer.data() + bytesRead, 1024);
         bytesRead += tmp;
 
         if (tmp < 1024)
@@ -66,6 +87,9 @@ bool testFile()
         case POD_CHECKSUM_CRC32:
             c1 = crc32(c1, buffer.data(), buffer.size() - 4);
             break;
+        case POD_CHECKSUM_CRC32C:
+            c1 = crc32c_reference(c1, buffer.data(), buffer.size() - 4);
+            break;
         default:
             break;
     }
@@ -94,9 +118,17 @@ bool test()
     int64_t i64[9];
     float f32[11];
     double f64[12];
+    std::vector<uint32_t> large(5003);
+
+    for (size_t i = 0; i != large.size(); ++i)
+    {
+        large[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
 
     auto container = pod_alloc();
 
+    pod_set_values(pod_get_item(container, "large"), large.data(), large.size(), POD_UINT32);
+
     pod_set_values(pod_get_item(container, "test string"), c8, 20, POD_ASCII_CHAR8);
 
     pod_set_values(pod_get_item(container, "UKeyA"), u8, 6, POD_UINT8);
@@ -127,8 +159,109 @@ bool test()
     return true;
 }
 
+// Checksums of every size and alignment must match the portable versions
+bool testUpdate()
+{
+    std::vector<uint8_t> data(4096 + 64);
+
+    for (size_t i = 0; i != data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>((i * 131u) ^ (i >> 5));
+    }
+
+    const char* check = "123456789";
+
+    if (checksum_update(POD_CHECKSUM_CRC32C, 0, reinterpret_cast<const uint8_t*>(check), 9) != 0xE3069283u)
+    {
+        std::cout << "crc32c check value doesn't match\n";
+        return false;
+    }
+
+    for (size_t offset : { 0, 1, 7 })
+    {
+        for (size_t size = 0; size <= 4096; size += (size < 300) ? 1 : 61)
+        {
+            const uint8_t* ptr = data.data() + offset;
+
+            uint32_t crc = checksum_update(POD_CHECKSUM_CRC32, 0x236534AAu, ptr, size);
+            uint32_t crcc = checksum_update(POD_CHECKSUM_CRC32C, 0x236534AAu, ptr, size);
+
+            if ((crc != crc32_z(0x236534AAu, ptr, size)) || (crcc != crc32c_reference(0x236534AAu, ptr, size)))
+            {
+                std::cout << "checksum of " << size << " bytes at offset " << offset << " doesn't match\n";
+                return false;
+            }
+
+            // checksums continue from the value of the bytes before
+
+            size_t half = size / 2;
+
+            if ((checksum_update(POD_CHECKSUM_CRC32, checksum_update(POD_CHECKSUM_CRC32, 0x236534AAu, ptr, half), ptr + half, size - half) != crc) ||
+                (checksum_update(POD_CHECKSUM_CRC32C, checksum_update(POD_CHECKSUM_CRC32C, 0x236534AAu, ptr, half), ptr + half, size - half) != crcc))
+            {
+                std::cout << "checksum of " << size << " bytes in two parts doesn't match\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Checksums of two spans combine into the checksum of both
+bool testCombine()
+{
+    std::vector<uint8_t> data(3u << 20);
+
+    for (size_t i = 0; i != data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+    }
+
+    for (auto checksum : { POD_CHECKSUM_ADLER32, POD_CHECKSUM_CRC32, POD_CHECKSUM_CRC32C })
+    {
+        for (size_t size : { size_t(0), size_t(1), size_t(100), size_t(5000), data.size() })
+        {
+            for (size_t first : { size_t(0), size_t(1), size_t(17), size / 3, size })
+            {
+                if (first > size)
+                {
+                    continue;
+                }
+
+                uint32_t expected = checksum_update(checksum, 0x236534AAu, data.data(), size);
+                uint32_t check1 = checksum_update(checksum, 0x236534AAu, data.data(), first);
+                uint32_t check2 = checksum_update(checksum, checksum_initial(checksum), data.data() + first, size - first);
+
+                if (checksum_combine(checksum, check1, check2, size - first) != expected)
+                {
+                    std::cout << "combined checksum of " << first << " and " << (size - first) << " bytes doesn't match, checksum " << checksum << "\n";
+                    return false;
+                }
+            }
+        }
+
+        // spans checksummed on a pool combine into the same checksum
+
+        ThreadPool pool(3);
+
+        if (checksum_update_parallel(checksum, 0x236534AAu, data.data(), data.size(), pool) != checksum_update(checksum, 0x236534AAu, data.data(), data.size()))
+        {
+            std::cout << "parallel checksum doesn't match, checksum " << checksum << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int main()
 {
+    if (!testUpdate() || !testCombine())
+    {
+        return -1;
+    }
+
     if (!test<POD_ENDIAN_NATIVE, POD_CHECKSUM_CRC32>())
     {
         std::cout << "failed, endian = " << POD_ENDIAN_NATIVE << ", checksum = " << POD_CHECKSUM_CRC32 << "\n";
@@ -165,5 +298,19 @@ int main()
         return -1;
     }
 
+    if (!test<POD_ENDIAN_LITTLE, POD_CHECKSUM_CRC32C>())
+    {
+        std::cout << "failed, endian = " << POD_ENDIAN_LITTLE << ", checksum = " << POD_CHECKSUM_CRC32C << "\n";
+        return -1;
+    }
+
+    if (!test<POD_ENDIAN_BIG, POD_CHECKSUM_CRC32C>())
+    {
+        std::cout << "failed, endian = " << POD_ENDIAN_BIG << ", checksum = " << POD_CHECKSUM_CRC32C << "\n";
+        return -1;
+    }
+
+    std::remove(fileName);
+
     return 0;
 }
@@ -0,0 +1,299 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+#include "PodHeader.h"
+#include "zlib.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const char* fileName = "count64_file.test.bin";
+
+std::vector<uint64_t> u64(100003);
+std::vector<int16_t> i16(40009);
+
+void init()
+{
+    for (size_t i = 0; i != u64.size(); ++i)
+    {
+        u64[i] = static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull;
+    }
+
+    for (size_t i = 0; i != i16.size(); ++i)
+    {
+        i16[i] = static_cast<int16_t>(i * 3);
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    auto item = pod_try_get_item(container, key);
+
+    size_t count;
+
+    if ((pod_try_count_values_ex(item, &count) != POD_SUCCESS) || (count != values.size()))
+    {
+        return false;
+    }
+
+    std::vector<T> copy(values.size());
+
+    return
+        (pod_try_copy_values_ex(item, copy.data(), copy.size(), type) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values.data(), values.size() * sizeof(T)) == 0);
+}
+
+bool check(pod_container_t* container)
+{
+    return
+        check_item(container, "u64", u64, POD_UINT64) &&
+        check_item(container, "i16", i16, POD_INT16);
+}
+
+// Returns a deflated COUNT64 file of one small block, whose count is replaced by count
+std::vector<uint8_t> patch_count(uint64_t count)
+{
+    uint8_t values[3] = { 1, 2, 3 };
+
+    auto container = pod_alloc();
+    pod_set_values(pod_get_item(container, "n"), values, 3, POD_UINT8);
+
+    void* saved;
+    uint64_t savedSize;
+
+    if (pod_save_memory(container, &saved, &savedSize, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_NONE, 0, POD_ENDIAN_LITTLE, POD_FLAGS_COUNT64) != POD_SUCCESS)
+    {
+        pod_free(container);
+        return {};
+    }
+
+    std::vector<uint8_t> file(static_cast<uint8_t*>(saved), static_cast<uint8_t*>(saved) + savedSize);
+    pod_free_memory(saved);
+    pod_free(container);
+
+    PodHeader header;
+    uint32_t check32 = 0;
+
+    if (read_header(file.data(), file.size(), header, POD_CHECKSUM_NONE, check32) != POD_SUCCESS)
+    {
+        return {};
+    }
+
+    // Inflate the block, patch the count that follows the key size and type, and deflate it again
+
+    uint8_t block[64];
+
+    z_stream zs {};
+    inflateInit2(&zs, -15);
+    zs.next_in = file.data() + header.size;
+    zs.avail_in = static_cast<uInt>(file.size() - header.size);
+    zs.next_out = block;
+    zs.avail_out = sizeof(block);
+    inflate(&zs, Z_FINISH);
+    size_t blockSize = sizeof(block) - zs.avail_out;
+    inflateEnd(&zs);
+
+    for (size_t i = 0; i != 8; ++i)
+    {
+        block[8 + i] = static_cast<uint8_t>(count >> (8 * i));
+    }
+
+    file.resize(header.size + 128);
+
+    zs = {};
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    zs.next_in = block;
+    zs.avail_in = static_cast<uInt>(blockSize);
+    zs.next_out = file.data() + header.size;
+    zs.avail_out = 128;
+    deflate(&zs, Z_FINISH);
+    file.resize(header.size + zs.total_out);
+    deflateEnd(&zs);
+
+    return file;
+}
+
+pod_result_t POD_API count_visitor(const char*, size_t, pod_type_t, size_t, const void*, void*)
+{
+    return POD_SUCCESS;
+}
+
+bool test(pod_container_t* src, pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_flags_t flags)
+{
+    flags = static_cast<pod_flags_t>(flags | POD_FLAGS_COUNT64);
+
+    if (pod_save_file_ex(src, fileName, compression, codec, POD_CHECKSUM_CRC32, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return false;
+    }
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    if ((pod_map_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to map file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if ((flags & POD_FLAGS_INDEX) != 0)
+    {
+        container = pod_alloc();
+
+        if ((pod_load_file_lazy(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+        {
+            std::cout << "failed to load lazily\n";
+            return false;
+        }
+
+        pod_free(container);
+    }
+
+    // The writer stores the same blocks
+
+    pod_writer_t* writer;
+
+    if ((pod_writer_open(&writer, fileName, compression, codec, POD_CHECKSUM_CRC32, 0, endian, flags) != POD_SUCCESS) ||
+        (pod_writer_add_item_ex(writer, "u64", u64.data(), u64.size(), POD_UINT64, POD_FILTER_DELTA) != POD_SUCCESS) ||
+        (pod_writer_add_item_ex(writer, "i16", i16.data(), i16.size(), POD_INT16, POD_FILTER_SHUFFLE) != POD_SUCCESS) ||
+        (pod_writer_close(writer) != POD_SUCCESS))
+    {
+        std::cout << "failed to write file\n";
+        return false;
+    }
+
+    container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load written file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    auto src = pod_alloc();
+
+    if ((pod_set_values_ex(pod_get_item(src, "u64"), u64.data(), u64.size(), POD_UINT64) != POD_SUCCESS) ||
+        (pod_set_values_ex(pod_get_item(src, "i16"), i16.data(), i16.size(), POD_INT16) != POD_SUCCESS) ||
+        (pod_set_filter(pod_get_item(src, "u64"), POD_FILTER_DELTA) != POD_SUCCESS) ||
+        (pod_set_filter(pod_get_item(src, "i16"), POD_FILTER_SHUFFLE) != POD_SUCCESS))
+    {
+        std::cout << "failed to set values\n";
+        return -1;
+    }
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_FILTER), POD_FLAGS_APPEND };
+
+    for (uint32_t threads : { 1u, 2u })
+    {
+        pod_set_thread_count(threads);
+
+        for (auto level : levels)
+        {
+            for (auto codec : codecs)
+            {
+                for (auto endian : endians)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(src, level, codec, endian, flag))
+                        {
+                            std::cout << "threads " << threads << ", level " << level << ", codec " << codec << ", endian " << endian << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Counts that don't fit in 32 bits need a writer opened with POD_FLAGS_COUNT64,
+    // and are rejected before the values are read
+
+    pod_writer_t* writer;
+
+    if (pod_writer_open(&writer, fileName, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_NONE, 0, POD_ENDIAN_NATIVE, POD_FLAGS_NONE) != POD_SUCCESS)
+    {
+        std::cout << "failed to open writer\n";
+        return -1;
+    }
+
+    if (pod_writer_add_item_ex(writer, "big", u64.data(), 0x100000001ull, POD_UINT8, POD_FILTER_NONE) != POD_OUT_OF_RANGE)
+    {
+        std::cout << "wrote a 64-bit count without POD_FLAGS_COUNT64\n";
+        return -1;
+    }
+
+    pod_writer_close(writer);
+
+    // More values than can be allocated are out of range, and leave the item as it was
+
+    size_t count = 0;
+
+    if ((pod_set_values_ex(pod_get_item(src, "u64"), u64.data(), 1ull << 62, POD_UINT8) != POD_OUT_OF_RANGE) ||
+        (pod_try_count_values_ex(pod_try_get_item(src, "u64"), &count) != POD_SUCCESS) || (count != u64.size()) ||
+        !check_item(src, "u64", u64, POD_UINT64))
+    {
+        std::cout << "allocated more values than memory can hold\n";
+        return -1;
+    }
+
+    pod_free(src);
+
+    // A corrupt count larger than the block could inflate to is rejected instead of allocated
+
+    auto patched = patch_count(1ull << 60);
+
+    if (patched.empty())
+    {
+        std::cout << "failed to patch the count of a file\n";
+        return -1;
+    }
+
+    FILE* fp = fopen(fileName, "wb");
+    fwrite(patched.data(), 1, patched.size(), fp);
+    fclose(fp);
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_NONE, 0) != POD_FILE_CORRUPT) ||
+        (pod_load_memory(container, patched.data(), patched.size(), POD_CHECKSUM_NONE, 0) != POD_FILE_CORRUPT) ||
+        (pod_visit_file(fileName, POD_CHECKSUM_NONE, 0, count_visitor, nullptr) != POD_FILE_CORRUPT))
+    {
+        std::cout << "loaded a block with a corrupt count\n";
+        return -1;
+    }
+
+    pod_free(container);
+
+    std::remove(fileName);
+
+    return 0;
+}
@@ -0,0 +1,269 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const char* fileName = "filter_file.test.bin";
+
+// Slowly changing values, similar to sensor readings
+std::vector<float> f32(10007);
+std::vector<double> f64(5003);
+std::vector<int32_t> i32(20011);
+std::vector<uint16_t> u16(3);
+std::vector<uint64_t> u64(4099);
+
+void init()
+{
+    for (size_t i = 0; i != f32.size(); ++i)
+    {
+        f32[i] = 20.0f + 5.0f * std::sin(static_cast<float>(i) * 0.01f);
+    }
+
+    for (size_t i = 0; i != f64.size(); ++i)
+    {
+        f64[i] = 1000.0 + static_cast<double>(i) * 0.125;
+    }
+
+    for (size_t i = 0; i != i32.size(); ++i)
+    {
+        i32[i] = static_cast<int32_t>(i * 3) - 1000;
+    }
+
+    for (size_t i = 0; i != u16.size(); ++i)
+    {
+        u16[i] = static_cast<uint16_t>(0x1234u * (i + 1));
+    }
+
+    // timestamps with some jitter
+    for (size_t i = 0; i != u64.size(); ++i)
+    {
+        u64[i] = 1700000000000ull + i * 1000ull + (i % 7);
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type, pod_filter_t filter)
+{
+    auto item = pod_try_get_item(container, key);
+
+    if (item == nullptr)
+    {
+        return false;
+    }
+
+    pod_filter_t itemFilter;
+    if ((pod_try_get_filter(item, &itemFilter) != POD_SUCCESS) || (itemFilter != filter))
+    {
+        return false;
+    }
+
+    uint32_t count;
+    if ((pod_try_count_values(item, &count) != POD_SUCCESS) || (count != values.size()))
+    {
+        return false;
+    }
+
+    std::vector<T> copy(count);
+
+    if (pod_try_copy_values(item, copy.data(), count, type) != POD_SUCCESS)
+    {
+        return false;
+    }
+
+    return memcmp(copy.data(), values.data(), count * sizeof(T)) == 0;
+}
+
+bool check(pod_container_t* container, pod_filter_t filter)
+{
+    return
+        check_item(container, "f32", f32, POD_FLOAT32, filter) &&
+        check_item(container, "f64", f64, POD_FLOAT64, filter) &&
+        check_item(container, "i32", i32, POD_INT32, POD_FILTER_NONE) &&
+        check_item(container, "u16", u16, POD_UINT16, filter) &&
+        check_item(container, "u64", u64, POD_UINT64, filter);
+}
+
+long file_size()
+{
+    FILE* file = fopen(fileName, "rb");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+bool save(pod_filter_t filter, pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_flags_t flags)
+{
+    auto container = pod_alloc();
+
+    auto f32Item = pod_get_item(container, "f32");
+    auto f64Item = pod_get_item(container, "f64");
+    auto i32Item = pod_get_item(container, "i32");
+    auto u16Item = pod_get_item(container, "u16");
+    auto u64Item = pod_get_item(container, "u64");
+
+    pod_set_values(f32Item, f32.data(), f32.size(), POD_FLOAT32);
+    pod_set_values(f64Item, f64.data(), f64.size(), POD_FLOAT64);
+    pod_set_values(i32Item, i32.data(), i32.size(), POD_INT32);
+    pod_set_values(u16Item, u16.data(), u16.size(), POD_UINT16);
+    pod_set_values(u64Item, u64.data(), u64.size(), POD_UINT64);
+
+    pod_set_filter(f32Item, filter);
+    pod_set_filter(f64Item, filter);
+    pod_set_filter(u16Item, filter);
+    pod_set_filter(u64Item, filter);
+
+    pod_result_t result = pod_save_file_ex(container, fileName, compression, codec, POD_CHECKSUM_CRC32, 0, endian, flags);
+
+    pod_free(container);
+
+    return result == POD_SUCCESS;
+}
+
+bool test(pod_filter_t filter, pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_flags_t flags)
+{
+    if (!save(filter, compression, codec, endian, flags))
+    {
+        std::cout << "failed to save\n";
+        return false;
+    }
+
+    // items only keep their filter if it was saved
+    pod_filter_t expected = ((flags & POD_FLAGS_FILTER) != 0) ? filter : POD_FILTER_NONE;
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container, expected))
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    if ((pod_map_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container, expected))
+    {
+        std::cout << "failed to map file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if ((flags & POD_FLAGS_INDEX) == 0)
+    {
+        return true;
+    }
+
+    container = pod_alloc();
+
+    if ((pod_load_file_lazy(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container, expected))
+    {
+        std::cout << "failed to load lazily\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    const char* keys[] = { "f32", "f64", "i32", "u16", "u64" };
+
+    container = pod_alloc();
+
+    if ((pod_load_items(container, fileName, POD_CHECKSUM_CRC32, 0, keys, 5) != POD_SUCCESS) || !check(container, expected))
+    {
+        std::cout << "failed to load items\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    const pod_filter_t filters[] =
+        {
+            POD_FILTER_NONE,
+            POD_FILTER_SHUFFLE,
+            POD_FILTER_BITSHUFFLE,
+            POD_FILTER_DELTA,
+            POD_FILTER_DELTA2,
+            POD_FILTER_XOR,
+            static_cast<pod_filter_t>(POD_FILTER_DELTA2 | POD_FILTER_SHUFFLE),
+            static_cast<pod_filter_t>(POD_FILTER_XOR | POD_FILTER_BITSHUFFLE),
+        };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_FILTER, static_cast<pod_flags_t>(POD_FLAGS_FILTER | POD_FLAGS_INDEX) };
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+
+    for (auto filter : filters)
+    {
+        for (auto flag : flags)
+        {
+            for (auto level : levels)
+            {
+                for (auto codec : codecs)
+                {
+                    for (auto endian : endians)
+                    {
+                        if (!test(filter, level, codec, endian, flag))
+                        {
+                            std::cout << "filter " << filter << ", flags " << flag << ", level " << level << ", codec " << codec << ", endian " << endian << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Filters should make slowly changing values smaller
+
+    if (!save(POD_FILTER_NONE, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_ENDIAN_NATIVE, POD_FLAGS_FILTER))
+    {
+        return -1;
+    }
+
+    long unfilteredSize = file_size();
+
+    for (auto filter : { POD_FILTER_SHUFFLE, POD_FILTER_BITSHUFFLE, POD_FILTER_DELTA, POD_FILTER_DELTA2, POD_FILTER_XOR })
+    {
+        if (!save(filter, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_ENDIAN_NATIVE, POD_FLAGS_FILTER))
+        {
+            return -1;
+        }
+
+        if (file_size() >= unfilteredSize)
+        {
+            std::cout << "filter " << filter << " didn't reduce the file size\n";
+            return -1;
+        }
+    }
+
+    // Unknown filters are rejected
+
+    auto container = pod_alloc();
+
+    if (pod_set_filter(pod_get_item(container, "x"), static_cast<pod_filter_t>(0x400u)) != POD_ARGUMENT_ERROR)
+    {
+        std::cout << "accepted an unknown filter\n";
+        return -1;
+    }
+
+    pod_free(container);
+
+    std::remove(fileName);
+
+    return 0;
+}
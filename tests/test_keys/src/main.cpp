@@ -0,0 +1,107 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main()
+{
+    auto container = pod_alloc();
+
+    // Keys with a length don't need a null terminator, and can hold null characters
+
+    const char keys[] = "position_x\0velocity";
+
+    auto position = pod_get_item_n(container, keys, 8);
+    auto nulled = pod_get_item_n(container, keys, sizeof(keys) - 1);
+
+    if ((position == nullptr) || (nulled == nullptr) || (position == nulled) ||
+        (pod_try_get_item(container, "position") != position) ||
+        (pod_get_item(container, "position") != position) ||
+        (pod_try_get_item_n(container, keys, sizeof(keys) - 1) != nulled) ||
+        (pod_try_get_item_n(container, keys, 10) != nullptr))
+    {
+        std::cout << "failed to get items by key size\n";
+        return -1;
+    }
+
+    uint32_t charCount = 0;
+    std::string key(sizeof(keys) - 1, ' ');
+
+    if ((pod_try_count_key_chars(nulled, &charCount) != POD_SUCCESS) || (charCount != key.size()) ||
+        (pod_try_copy_key(nulled, key.data(), charCount) != POD_SUCCESS) || (memcmp(key.data(), keys, key.size()) != 0))
+    {
+        std::cout << "key with a null character changed\n";
+        return -1;
+    }
+
+    if ((pod_get_item_n(container, nullptr, 1) != nullptr) || (pod_get_item_n(nullptr, keys, 1) != nullptr) ||
+        (pod_try_get_item_n(container, nullptr, 1) != nullptr) || (pod_get_item(container, nullptr) != nullptr))
+    {
+        std::cout << "accepted a null key or container\n";
+        return -1;
+    }
+
+    // Interned keys find the same items, in any container
+
+    auto interned = pod_intern_key("position", 8);
+    auto missing = pod_intern_key("missing", 7);
+    auto empty = pod_intern_key(nullptr, 0);
+
+    if ((interned == nullptr) || (missing == nullptr) || (empty == nullptr) || (pod_intern_key(nullptr, 1) != nullptr))
+    {
+        std::cout << "failed to intern keys\n";
+        return -1;
+    }
+
+    if ((pod_try_get_item_key(container, interned) != position) ||
+        (pod_get_item_key(container, interned) != position) ||
+        (pod_try_get_item_key(container, missing) != nullptr) ||
+        (pod_get_item_key(container, empty) != pod_try_get_item(container, "")) ||
+        (pod_try_get_item_key(container, nullptr) != nullptr) ||
+        (pod_get_item_key(nullptr, interned) != nullptr))
+    {
+        std::cout << "failed to get items by interned key\n";
+        return -1;
+    }
+
+    auto other = pod_alloc();
+    auto created = pod_get_item_key(other, missing);
+
+    if ((created == nullptr) || (pod_try_get_item(other, "missing") != created) || (pod_try_get_item_key(other, missing) != created))
+    {
+        std::cout << "failed to add an item by interned key\n";
+        return -1;
+    }
+
+    // Interned keys still find items that were removed and added again
+
+    pod_remove_item(container, position);
+
+    if (pod_try_get_item_key(container, interned) != nullptr)
+    {
+        std::cout << "found a removed item\n";
+        return -1;
+    }
+
+    position = pod_get_item(container, "position");
+
+    if (pod_try_get_item_key(container, interned) != position)
+    {
+        std::cout << "failed to find an item added again\n";
+        return -1;
+    }
+
+    pod_free_key(interned);
+    pod_free_key(missing);
+    pod_free_key(empty);
+    pod_free_key(nullptr);
+
+    pod_free(other);
+    pod_free(container);
+
+    return 0;
+}
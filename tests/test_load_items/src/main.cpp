@@ -0,0 +1,307 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+const char* fileName = "load_items_file.test.bin";
+
+bool create(pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_checksum_t checksum, pod_flags_t flags)
+{
+    std::vector<uint32_t> u32(1000);
+    std::vector<double> f64(2000);
+    const char* str = "some text";
+
+    for (size_t i = 0; i != u32.size(); ++i)
+    {
+        u32[i] = static_cast<uint32_t>(i * 7u);
+    }
+
+    for (size_t i = 0; i != f64.size(); ++i)
+    {
+        f64[i] = static_cast<double>(i) * 0.25;
+    }
+
+    auto container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "u32"), u32.data(), u32.size(), POD_UINT32);
+    pod_set_values(pod_get_item(container, "f64"), f64.data(), f64.size(), POD_FLOAT64);
+    pod_set_values(pod_get_item(container, "str"), str, strlen(str), POD_UTF8_CHAR8);
+    pod_set_values(pod_get_item(container, "empty"), nullptr, 0, POD_INT16);
+
+    pod_result_t result = pod_save_file_ex(container, fileName, compression, codec, checksum, 0x01020304u, endian, flags);
+
+    pod_free(container);
+
+    return result == POD_SUCCESS;
+}
+
+bool check(pod_container_t* container, const char* key, bool exists)
+{
+    auto item = pod_try_get_item(container, key);
+
+    if (item == nullptr)
+    {
+        return !exists;
+    }
+
+    if (!exists)
+    {
+        return false;
+    }
+
+    uint32_t count;
+    if (pod_try_count_values(item, &count) != POD_SUCCESS)
+    {
+        return false;
+    }
+
+    if (strcmp(key, "u32") == 0)
+    {
+        std::vector<uint32_t> u32(count);
+
+        if (count != 1000 || pod_try_copy_values(item, u32.data(), count, POD_UINT32) != POD_SUCCESS)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i != u32.size(); ++i)
+        {
+            if (u32[i] != static_cast<uint32_t>(i * 7u))
+            {
+                return false;
+            }
+        }
+    }
+    else if (strcmp(key, "f64") == 0)
+    {
+        std::vector<double> f64(count);
+
+        if (count != 2000 || pod_try_copy_values(item, f64.data(), count, POD_FLOAT64) != POD_SUCCESS)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i != f64.size(); ++i)
+        {
+            if (f64[i] != static_cast<double>(i) * 0.25)
+            {
+                return false;
+            }
+        }
+    }
+    else if (strcmp(key, "str") == 0)
+    {
+        std::vector<char> str(count);
+
+        if (count != 9 || pod_try_copy_values(item, str.data(), count, POD_UTF8_CHAR8) != POD_SUCCESS)
+        {
+            return false;
+        }
+
+        if (memcmp(str.data(), "some text", 9) != 0)
+        {
+            return false;
+        }
+    }
+    else if (strcmp(key, "empty") == 0)
+    {
+        if (count != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test(pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_checksum_t checksum, pod_flags_t flags)
+{
+    if (!create(compression, codec, endian, checksum, flags))
+    {
+        std::cout << "failed to save\n";
+        return false;
+    }
+
+    // Load everything
+
+    auto container = pod_alloc();
+
+    if (pod_load_file(container, fileName, checksum, 0x01020304u) != POD_SUCCESS)
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    if (!check(container, "u32", true) || !check(container, "f64", true) ||
+        !check(container, "str", true) || !check(container, "empty", true))
+    {
+        std::cout << "failed to validate file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    // Load some items
+
+    const char* keys[] = { "f64", "missing", "str" };
+
+    container = pod_alloc();
+
+    if (pod_load_items(container, fileName, checksum, 0x01020304u, keys, 3) != POD_SUCCESS)
+    {
+        std::cout << "failed to load items\n";
+        return false;
+    }
+
+    if (!check(container, "u32", false) || !check(container, "f64", true) ||
+        !check(container, "str", true) || !check(container, "empty", false) ||
+        !check(container, "missing", false))
+    {
+        std::cout << "failed to validate items\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    // Load lazily, then save over the same file
+
+    container = pod_alloc();
+
+    if (pod_load_file_lazy(container, fileName, checksum, 0x01020304u) != POD_SUCCESS)
+    {
+        std::cout << "failed to load lazily\n";
+        return false;
+    }
+
+    if (!check(container, "f64", true))
+    {
+        std::cout << "failed to validate lazy item\n";
+        return false;
+    }
+
+    if (pod_save_file_ex(container, fileName, compression, codec, checksum, 0x01020304u, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save lazy container\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    if (pod_load_file(container, fileName, checksum, 0x01020304u) != POD_SUCCESS)
+    {
+        std::cout << "failed to load saved lazy container\n";
+        return false;
+    }
+
+    if (!check(container, "u32", true) || !check(container, "f64", true) ||
+        !check(container, "str", true) || !check(container, "empty", true))
+    {
+        std::cout << "failed to validate saved lazy container\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+bool test(pod_endian_t endian, pod_checksum_t checksum, pod_flags_t flags)
+{
+    for (uint32_t i = POD_COMPRESSION_0; i <= POD_COMPRESSION_9; ++i)
+    {
+        if (!test(static_cast<pod_compression_t>(i), POD_CODEC_DEFLATE, endian, checksum, flags))
+        {
+            std::cout << "failed, compression = " << i << ", endian = " << endian << ", checksum = " << checksum << ", flags = " << flags << "\n";
+            return false;
+        }
+    }
+
+    if (!test(POD_COMPRESSION_DEFAULT, POD_CODEC_LZ, endian, checksum, flags))
+    {
+        std::cout << "failed, codec = LZ, endian = " << endian << ", checksum = " << checksum << ", flags = " << flags << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    const pod_endian_t endians[] = { POD_ENDIAN_NATIVE, POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_ADLER32, POD_CHECKSUM_CRC32 };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX };
+
+    for (auto endian : endians)
+    {
+        for (auto checksum : checksums)
+        {
+            for (auto flag : flags)
+            {
+                if (!test(endian, checksum, flag))
+                {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A corrupt block leaves its item as it was, and doesn't add an item
+
+    if (!create(POD_COMPRESSION_0, POD_CODEC_DEFLATE, POD_ENDIAN_NATIVE, POD_CHECKSUM_CRC32, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_BLOCK_CHECKSUM)))
+    {
+        std::cout << "failed to save\n";
+        return -1;
+    }
+
+    {
+        // the middle of the file is in the block of f64
+        FILE* file = fopen(fileName, "r+b");
+        fseek(file, 0, SEEK_END);
+        long middle = ftell(file) / 2;
+        fseek(file, middle, SEEK_SET);
+        int byte = fgetc(file);
+        fseek(file, middle, SEEK_SET);
+        fputc(byte ^ 0xFF, file);
+        fclose(file);
+    }
+
+    const char* corruptKeys[] = { "f64" };
+    uint8_t kept[3] = { 1, 2, 3 };
+
+    auto container = pod_alloc();
+    auto added = pod_alloc();
+    pod_set_values(pod_get_item(container, "f64"), kept, 3, POD_UINT8);
+
+    uint8_t copy[3] = {};
+    uint32_t count = 0;
+    auto item = pod_try_get_item(container, "f64");
+
+    if ((pod_load_items(container, fileName, POD_CHECKSUM_CRC32, 0x01020304u, corruptKeys, 1) != POD_FILE_CORRUPT) ||
+        (pod_try_count_values(item, &count) != POD_SUCCESS) || (count != 3) ||
+        (pod_try_copy_values(item, copy, 3, POD_UINT8) != POD_SUCCESS) || (memcmp(copy, kept, 3) != 0))
+    {
+        std::cout << "a corrupt block changed its item\n";
+        return -1;
+    }
+
+    if ((pod_load_items(added, fileName, POD_CHECKSUM_CRC32, 0x01020304u, corruptKeys, 1) != POD_FILE_CORRUPT) ||
+        (pod_try_get_item(added, "f64") != nullptr))
+    {
+        std::cout << "a corrupt block added its item\n";
+        return -1;
+    }
+
+    pod_free(added);
+    pod_free(container);
+
+    std::remove(fileName);
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const char* fileName = "item_map_file.test.bin";
+
+const size_t itemCount = 50000;
+
+std::string key_of(size_t i)
+{
+    // some keys are longer than the small string limit
+    return ((i % 3) == 0) ? "item_with_a_long_key_" + std::to_string(i) : std::to_string(i);
+}
+
+bool check_value(pod_item_t* item, uint32_t expected)
+{
+    uint32_t value = 0;
+    return (item != nullptr) && (pod_try_copy_values(item, &value, 1, POD_UINT32) == POD_SUCCESS) && (value == expected);
+}
+
+// Returns the values of every item, in iteration order
+std::vector<uint32_t> walk(pod_container_t* container)
+{
+    std::vector<uint32_t> values;
+
+    for (auto item = pod_get_first_item(container); item != nullptr; item = pod_get_next_item(container, item))
+    {
+        uint32_t value = 0;
+        pod_try_copy_values(item, &value, 1, POD_UINT32);
+        values.push_back(value);
+    }
+
+    return values;
+}
+
+int main()
+{
+    auto container = pod_alloc();
+
+    if ((pod_reserve(container, itemCount) != POD_SUCCESS) || (pod_reserve(nullptr, 1) != POD_NULL_REFERENCE))
+    {
+        std::cout << "failed to reserve items\n";
+        return -1;
+    }
+
+    // More items than a table can hold are out of range, and leave the container as it was
+
+    if ((pod_reserve(container, SIZE_MAX) != POD_OUT_OF_RANGE) || (pod_reserve(container, SIZE_MAX / 2) != POD_OUT_OF_RANGE))
+    {
+        std::cout << "reserved more items than a table can hold\n";
+        return -1;
+    }
+
+    // Handles stay valid while the container grows
+
+    std::vector<pod_item_t*> items;
+
+    for (size_t i = 0; i != itemCount * 2; ++i)
+    {
+        auto value = static_cast<uint32_t>(i);
+        auto item = pod_get_item(container, key_of(i).c_str());
+
+        if ((item == nullptr) || (pod_set_values(item, &value, 1, POD_UINT32) != POD_SUCCESS))
+        {
+            std::cout << "failed to add item " << i << "\n";
+            return -1;
+        }
+
+        items.push_back(item);
+    }
+
+    for (size_t i = 0; i != items.size(); ++i)
+    {
+        if ((pod_try_get_item(container, key_of(i).c_str()) != items[i]) || !check_value(items[i], static_cast<uint32_t>(i)))
+        {
+            std::cout << "item " << i << " moved or changed\n";
+            return -1;
+        }
+    }
+
+    // Removed items are gone, and the rest are still found
+
+    for (size_t i = 0; i < items.size(); i += 2)
+    {
+        if (pod_remove_item(container, items[i]) != POD_SUCCESS)
+        {
+            std::cout << "failed to remove item " << i << "\n";
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i != items.size(); ++i)
+    {
+        auto item = pod_try_get_item(container, key_of(i).c_str());
+
+        if (((i % 2) == 0) ? (item != nullptr) : ((item != items[i]) || !check_value(item, static_cast<uint32_t>(i))))
+        {
+            std::cout << "failed to find item " << i << " after removing items\n";
+            return -1;
+        }
+    }
+
+    // Items are iterated in the order they were added, skipping removed items
+
+    std::vector<uint32_t> expected;
+
+    for (size_t i = 1; i < items.size(); i += 2)
+    {
+        expected.push_back(static_cast<uint32_t>(i));
+    }
+
+    if (walk(container) != expected)
+    {
+        std::cout << "items aren't in insertion order\n";
+        return -1;
+    }
+
+    // Items can be added again, and a new item has no values
+
+    uint32_t count = 1;
+    auto item = pod_get_item(container, key_of(0).c_str());
+
+    if ((pod_try_count_values(item, &count) != POD_SUCCESS) || (count != 0))
+    {
+        std::cout << "added item has values\n";
+        return -1;
+    }
+
+    pod_remove_item(container, item);
+
+    // Items added after removing others go last, and an empty key is a key like any other
+
+    uint32_t value = 7;
+
+    if ((pod_set_values(pod_get_item(container, ""), &value, 1, POD_UINT32) != POD_SUCCESS) ||
+        !check_value(pod_try_get_item(container, ""), 7))
+    {
+        std::cout << "failed to use an empty key\n";
+        return -1;
+    }
+
+    expected.push_back(value);
+
+    if (walk(container) != expected)
+    {
+        std::cout << "added item isn't last\n";
+        return -1;
+    }
+
+    // Every item is saved and loaded
+
+    if (pod_save_file(container, fileName, POD_COMPRESSION_DEFAULT, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return -1;
+    }
+
+    auto loaded = pod_alloc();
+
+    if (pod_load_file(loaded, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS)
+    {
+        std::cout << "failed to load file\n";
+        return -1;
+    }
+
+    for (size_t i = 1; i < items.size(); i += 2)
+    {
+        if (!check_value(pod_try_get_item(loaded, key_of(i).c_str()), static_cast<uint32_t>(i)))
+        {
+            std::cout << "failed to load item " << i << "\n";
+            return -1;
+        }
+    }
+
+    if (!check_value(pod_try_get_item(loaded, ""), 7) || (pod_try_get_item(loaded, key_of(0).c_str()) != nullptr))
+    {
+        std::cout << "loaded the wrong items\n";
+        return -1;
+    }
+
+    // Items are saved in order, and loaded in the same order
+
+    if (walk(loaded) != expected)
+    {
+        std::cout << "loaded items aren't in the saved order\n";
+        return -1;
+    }
+
+    pod_free(loaded);
+    pod_free(container);
+
+    std::remove(fileName);
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+const char* fileName = "map_file.test.bin";
+
+bool test(pod_compression_t compression, pod_endian_t endian, pod_checksum_t checksum, pod_flags_t flags)
+{
+    std::vector<uint64_t> u64(5000);
+    std::vector<float> f32(3000);
+
+    for (size_t i = 0; i != u64.size(); ++i)
+    {
+        u64[i] = i * 0x0101010101ull;
+    }
+
+    for (size_t i = 0; i != f32.size(); ++i)
+    {
+        f32[i] = static_cast<float>(i) * 0.5f;
+    }
+
+    auto container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "u64"), u64.data(), u64.size(), POD_UINT64);
+    pod_set_values(pod_get_item(container, "f32"), f32.data(), f32.size(), POD_FLOAT32);
+    pod_set_values(pod_get_item(container, "empty"), nullptr, 0, POD_UINT8);
+
+    if (pod_save_file_ex(container, fileName, compression, POD_CODEC_DEFLATE, checksum, 0x01020304u, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    if (pod_map_file(container, fileName, checksum, 0x01020304u) != POD_SUCCESS)
+    {
+        std::cout << "failed to map\n";
+        return false;
+    }
+
+    // Read values in place
+
+    auto item = pod_try_get_item(container, "u64");
+    const void* values;
+    uint32_t count;
+
+    if (pod_try_count_values(item, &count) != POD_SUCCESS || count != u64.size())
+    {
+        std::cout << "wrong count\n";
+        return false;
+    }
+
+    if (pod_try_get_values(item, &values, POD_UINT64) != POD_SUCCESS || memcmp(values, u64.data(), u64.size() * sizeof(uint64_t)) != 0)
+    {
+        std::cout << "wrong values\n";
+        return false;
+    }
+
+    if (pod_try_get_values(item, &values, POD_FLOAT32) != POD_TYPE_MISMATCH)
+    {
+        std::cout << "expected type mismatch\n";
+        return false;
+    }
+
+    // Copy values out of the mapping
+
+    std::vector<float> n_f32(f32.size());
+    item = pod_try_get_item(container, "f32");
+
+    if (pod_try_copy_values(item, n_f32.data(), n_f32.size(), POD_FLOAT32) != POD_SUCCESS || n_f32 != f32)
+    {
+        std::cout << "wrong copied values\n";
+        return false;
+    }
+
+    item = pod_try_get_item(container, "empty");
+
+    if (pod_try_count_values(item, &count) != POD_SUCCESS || count != 0)
+    {
+        std::cout << "wrong empty count\n";
+        return false;
+    }
+
+    // Setting values replaces the mapped values
+
+    uint16_t u16[3] = { 1, 2, 3 };
+    item = pod_try_get_item(container, "u64");
+
+    if (pod_set_values(item, u16, 3, POD_UINT16) != POD_SUCCESS ||
+        pod_try_get_values(item, &values, POD_UINT16) != POD_SUCCESS ||
+        memcmp(values, u16, sizeof(u16)) != 0)
+    {
+        std::cout << "failed to set mapped item\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    const pod_compression_t compressions[] = { POD_COMPRESSION_0, POD_COMPRESSION_6 };
+    const pod_endian_t endians[] = { POD_ENDIAN_NATIVE, POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_ADLER32, POD_CHECKSUM_CRC32 };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX };
+
+    for (auto compression : compressions)
+    {
+        for (auto endian : endians)
+        {
+            for (auto checksum : checksums)
+            {
+                for (auto flag : flags)
+                {
+                    if (!test(compression, endian, checksum, flag))
+                    {
+                        std::cout << "failed, compression = " << compression << ", endian = " << endian << ", checksum = " << checksum << ", flags = " << flag << "\n";
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const char* fileName = "memory_file.test.bin";
+
+std::vector<double> f64(200003);
+std::vector<int32_t> i32(7001);
+
+void init()
+{
+    for (size_t i = 0; i != f64.size(); ++i)
+    {
+        f64[i] = static_cast<double>(i % 977) * 0.25;
+    }
+
+    for (size_t i = 0; i != i32.size(); ++i)
+    {
+        i32[i] = static_cast<int32_t>(i * 31) - 5000;
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    std::vector<T> copy(values.size());
+
+    return
+        (pod_try_copy_values(pod_try_get_item(container, key), copy.data(), copy.size(), type) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values.data(), values.size() * sizeof(T)) == 0);
+}
+
+bool check(pod_container_t* container)
+{
+    return
+        check_item(container, "f64", f64, POD_FLOAT64) &&
+        check_item(container, "i32", i32, POD_INT32);
+}
+
+std::vector<uint8_t> read_file(const char* name)
+{
+    std::vector<uint8_t> bytes;
+    FILE* file = fopen(name, "rb");
+
+    if (file != nullptr)
+    {
+        uint8_t buffer[4096];
+        size_t size;
+
+        while ((size = fread(buffer, 1, sizeof(buffer), file)) != 0)
+        {
+            bytes.insert(bytes.end(), buffer, buffer + size);
+        }
+
+        fclose(file);
+    }
+
+    return bytes;
+}
+
+bool test(pod_container_t* src, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, pod_endian_t endian, pod_flags_t flags)
+{
+    // A buffer holds the same bytes as a file
+
+    if (pod_save_file_ex(src, fileName, compression, codec, checksum, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return false;
+    }
+
+    void* buffer;
+    uint64_t size;
+
+    if (pod_save_memory(src, &buffer, &size, compression, codec, checksum, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save memory\n";
+        return false;
+    }
+
+    auto bytes = read_file(fileName);
+
+    if ((bytes.size() != size) || (memcmp(bytes.data(), buffer, size) != 0))
+    {
+        std::cout << "memory doesn't match file\n";
+        return false;
+    }
+
+    auto container = pod_alloc();
+
+    if ((pod_load_memory(container, buffer, size, checksum, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load memory\n";
+        return false;
+    }
+
+    pod_free(container);
+    pod_free_memory(buffer);
+
+    // Query the size, then save into a buffer that is too small and one that fits
+
+    uint64_t required;
+
+    if ((pod_save_memory_into(src, nullptr, 0, &required, compression, codec, checksum, 0, endian, flags) != POD_OUT_OF_RANGE) || (required != size))
+    {
+        std::cout << "failed to query size\n";
+        return false;
+    }
+
+    std::vector<uint8_t> small(required - 1);
+
+    if ((pod_save_memory_into(src, small.data(), small.size(), &size, compression, codec, checksum, 0, endian, flags) != POD_OUT_OF_RANGE) || (size != required))
+    {
+        std::cout << "saved into a buffer that is too small\n";
+        return false;
+    }
+
+    std::vector<uint8_t> fits(required);
+
+    if ((pod_save_memory_into(src, fits.data(), fits.size(), &size, compression, codec, checksum, 0, endian, flags) != POD_SUCCESS) || (fits != bytes))
+    {
+        std::cout << "failed to save into buffer\n";
+        return false;
+    }
+
+    // A truncated buffer is corrupt
+
+    container = pod_alloc();
+
+    if (pod_load_memory(container, fits.data(), fits.size() - 1, checksum, 0) == POD_SUCCESS)
+    {
+        std::cout << "loaded a truncated buffer\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    auto src = pod_alloc();
+
+    if ((pod_set_values(pod_get_item(src, "f64"), f64.data(), f64.size(), POD_FLOAT64) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "i32"), i32.data(), i32.size(), POD_INT32) != POD_SUCCESS))
+    {
+        std::cout << "failed to set values\n";
+        return -1;
+    }
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_APPEND) };
+
+    for (uint32_t threads : { 1u, 2u })
+    {
+        pod_set_thread_count(threads);
+
+        for (auto level : levels)
+        {
+            for (auto codec : codecs)
+            {
+                for (auto endian : endians)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(src, level, codec, POD_CHECKSUM_CRC32, endian, flag))
+                        {
+                            std::cout << "threads " << threads << ", level " << level << ", codec " << codec << ", endian " << endian << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    pod_free(src);
+
+    std::remove(fileName);
+
+    return 0;
+}
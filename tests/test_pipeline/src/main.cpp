@@ -0,0 +1,196 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const char* fileName = "pipeline_file.test.bin";
+
+std::vector<uint32_t> big(300007);
+std::vector<uint8_t> small(17);
+std::vector<double> mid(20011);
+
+void init()
+{
+    uint32_t x = 12345;
+
+    for (size_t i = 0; i != big.size(); ++i)
+    {
+        // mix of random and repeated values, so compressed files span several chunks
+        x = x * 1103515245u + 12345u;
+        big[i] = ((i / 64) % 2 == 0) ? x : static_cast<uint32_t>(i / 64);
+    }
+
+    for (size_t i = 0; i != small.size(); ++i)
+    {
+        small[i] = static_cast<uint8_t>(i);
+    }
+
+    for (size_t i = 0; i != mid.size(); ++i)
+    {
+        mid[i] = static_cast<double>(i) / 3.0;
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    auto item = pod_try_get_item(container, key);
+
+    uint32_t count;
+
+    if ((pod_try_count_values(item, &count) != POD_SUCCESS) || (count != values.size()))
+    {
+        return false;
+    }
+
+    std::vector<T> copy(values.size());
+
+    return
+        (pod_try_copy_values(item, copy.data(), copy.size(), type) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values.data(), values.size() * sizeof(T)) == 0);
+}
+
+bool check(pod_container_t* container)
+{
+    return
+        check_item(container, "big", big, POD_UINT32) &&
+        check_item(container, "small", small, POD_UINT8) &&
+        check_item(container, "mid", mid, POD_FLOAT64);
+}
+
+pod_result_t POD_API count_items(const char*, size_t, pod_type_t, size_t, const void*, void* user)
+{
+    ++*static_cast<size_t*>(user);
+    return POD_SUCCESS;
+}
+
+bool test(pod_container_t* src, pod_compression_t compression, pod_codec_t codec, pod_flags_t flags)
+{
+    if (pod_save_file_ex(src, fileName, compression, codec, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_BIG, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return false;
+    }
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    size_t count = 0;
+
+    if ((pod_visit_file(fileName, POD_CHECKSUM_CRC32, 0, count_items, &count) != POD_SUCCESS) || (count != 3))
+    {
+        std::cout << "failed to visit file\n";
+        return false;
+    }
+
+    if ((flags & POD_FLAGS_INDEX) != 0)
+    {
+        container = pod_alloc();
+
+        if ((pod_load_file_lazy(container, fileName, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS) || !check(container))
+        {
+            std::cout << "failed to load lazily\n";
+            return false;
+        }
+
+        pod_free(container);
+    }
+
+    // a truncated file is still corrupt
+
+    auto file = fopen(fileName, "rb");
+    fseek(file, 0, SEEK_END);
+    std::vector<uint8_t> bytes(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    size_t size = fread(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+
+    file = fopen(fileName, "wb");
+    fwrite(bytes.data(), 1, size / 2, file);
+    fclose(file);
+
+    container = pod_alloc();
+
+    if (pod_load_file(container, fileName, POD_CHECKSUM_CRC32, 0) == POD_SUCCESS)
+    {
+        std::cout << "loaded a truncated file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    if (pod_set_io_buffer_size(2ull << 30) != POD_OUT_OF_RANGE)
+    {
+        std::cout << "accepted a buffer size over 1 GiB\n";
+        return -1;
+    }
+
+    auto src = pod_alloc();
+
+    if ((pod_set_values(pod_get_item(src, "big"), big.data(), big.size(), POD_UINT32) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "small"), small.data(), small.size(), POD_UINT8) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "mid"), mid.data(), mid.size(), POD_FLOAT64) != POD_SUCCESS))
+    {
+        std::cout << "failed to set values\n";
+        return -1;
+    }
+
+    const uint64_t bufferSizes[] = { 0, 1000, 4096, 65536, 1u << 20 };
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX };
+
+    for (auto bufferSize : bufferSizes)
+    {
+        if (pod_set_io_buffer_size(bufferSize) != POD_SUCCESS)
+        {
+            std::cout << "failed to set buffer size\n";
+            return -1;
+        }
+
+        for (uint32_t threads : { 1u, 2u })
+        {
+            pod_set_thread_count(threads);
+
+            for (auto level : levels)
+            {
+                for (auto codec : codecs)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(src, level, codec, flag))
+                        {
+                            std::cout << "buffer size " << bufferSize << ", threads " << threads << ", level " << level << ", codec " << codec << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    pod_free(src);
+
+    std::remove(fileName);
+
+    return 0;
+}
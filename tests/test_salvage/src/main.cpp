@@ -0,0 +1,374 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const char* fileName = "salvage_file.test.bin";
+const char* keys[] = { "a", "b", "c" };
+
+std::vector<uint32_t> values[3];
+
+void init()
+{
+    uint32_t x = 777;
+
+    for (auto& v : values)
+    {
+        v.resize(30011);
+
+        for (auto& value : v)
+        {
+            x = x * 1103515245u + 12345u;
+            value = x;
+        }
+    }
+}
+
+bool check_item(pod_container_t* container, size_t i)
+{
+    auto item = pod_try_get_item(container, keys[i]);
+
+    uint32_t count;
+
+    if ((pod_try_count_values(item, &count) != POD_SUCCESS) || (count != values[i].size()))
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> copy(count);
+
+    return
+        (pod_try_copy_values(item, copy.data(), copy.size(), POD_UINT32) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values[i].data(), count * 4) == 0);
+}
+
+bool check(pod_container_t* container)
+{
+    return check_item(container, 0) && check_item(container, 1) && check_item(container, 2);
+}
+
+// Returns true if the values of every item in a container can be copied
+bool check_all(pod_container_t* container)
+{
+    for (auto item = pod_get_first_item(container); item != nullptr; item = pod_get_next_item(container, item))
+    {
+        size_t count;
+        pod_type_t type;
+        const void* ptr;
+
+        if ((pod_try_count_values_ex(item, &count) != POD_SUCCESS) || (pod_try_get_type(item, &type) != POD_SUCCESS))
+        {
+            return false;
+        }
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        std::vector<uint8_t> copy(count * 8);
+
+        if ((pod_try_get_values(item, &ptr, type) != POD_SUCCESS) || (ptr == nullptr) ||
+            (pod_try_copy_values_ex(item, copy.data(), count, type) != POD_SUCCESS))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void POD_API salvage_callback(const char* key, size_t keySize, void* user)
+{
+    static_cast<std::vector<std::string>*>(user)->emplace_back(key, keySize);
+}
+
+bool test(pod_container_t* src, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, pod_endian_t endianness, pod_flags_t flags)
+{
+    const uint32_t checksumValue = 99;
+
+    flags = static_cast<pod_flags_t>(flags | POD_FLAGS_BLOCK_CHECKSUM);
+
+    if (pod_save_file_ex(src, fileName, compression, codec, checksum, checksumValue, endianness, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return false;
+    }
+
+    // Intact files load every way
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, checksum, checksumValue) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    pod_free(container);
+    container = pod_alloc();
+
+    if ((pod_load_file_lazy(container, fileName, checksum, checksumValue) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load file lazily\n";
+        return false;
+    }
+
+    pod_free(container);
+    container = pod_alloc();
+
+    if ((pod_load_items(container, fileName, checksum, checksumValue, keys + 1, 1) != POD_SUCCESS) || !check_item(container, 1))
+    {
+        std::cout << "failed to load items\n";
+        return false;
+    }
+
+    pod_free(container);
+    container = pod_alloc();
+
+    std::vector<std::string> corrupt;
+
+    if ((pod_salvage_file(container, fileName, checksum, checksumValue, salvage_callback, &corrupt) != POD_SUCCESS) || !check(container) || !corrupt.empty())
+    {
+        std::cout << "failed to salvage an intact file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if (pod_verify_file(fileName, checksum, checksumValue) != POD_SUCCESS)
+    {
+        std::cout << "failed to verify file\n";
+        return false;
+    }
+
+    // Flip a byte in the block in the middle of the file
+
+    auto file = fopen(fileName, "rb");
+    fseek(file, 0, SEEK_END);
+    std::vector<uint8_t> bytes(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+    fclose(file);
+
+    bytes[bytes.size() / 2] ^= 0x01u;
+
+    file = fopen(fileName, "wb");
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+
+    // Items left after a failed load have all of their values, and items that were there before are kept
+
+    container = pod_alloc();
+
+    uint32_t kept = 3;
+
+    if ((pod_set_values(pod_get_item(container, "kept"), &kept, 1, POD_UINT32) != POD_SUCCESS) ||
+        (pod_load_file(container, fileName, checksum, checksumValue) != POD_FILE_CORRUPT))
+    {
+        std::cout << "loaded a corrupt file\n";
+        return false;
+    }
+
+    if (!check_all(container) || (pod_try_copy_values(pod_try_get_item(container, "kept"), &kept, 1, POD_UINT32) != POD_SUCCESS) || (kept != 3))
+    {
+        std::cout << "corrupt file left items without values\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if (pod_verify_file(fileName, checksum, checksumValue) != POD_FILE_CORRUPT)
+    {
+        std::cout << "verified a corrupt file\n";
+        return false;
+    }
+
+    // Every other item is salvaged
+
+    container = pod_alloc();
+    corrupt.clear();
+
+    if ((pod_salvage_file(container, fileName, checksum, checksumValue, salvage_callback, &corrupt) != POD_FILE_CORRUPT) || (corrupt.size() != 1))
+    {
+        std::cout << "failed to report the corrupt item\n";
+        return false;
+    }
+
+    size_t count = 0;
+
+    for (size_t i = 0; i != 3; ++i)
+    {
+        if (corrupt[0] == keys[i])
+        {
+            if (pod_try_get_item(container, keys[i]) != nullptr)
+            {
+                std::cout << "loaded the corrupt item\n";
+                return false;
+            }
+        }
+        else if (check_item(container, i))
+        {
+            ++count;
+        }
+    }
+
+    if (count != 2)
+    {
+        std::cout << "failed to salvage intact items\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    // An item that was already in the container keeps its values if its block is corrupt
+
+    container = pod_alloc();
+    uint8_t existing = 7;
+    pod_set_values(pod_get_item(container, corrupt[0].c_str()), &existing, 1, POD_UINT8);
+
+    uint8_t value = 0;
+
+    if ((pod_salvage_file(container, fileName, checksum, checksumValue, nullptr, nullptr) != POD_FILE_CORRUPT) ||
+        (pod_try_copy_values(pod_try_get_item(container, corrupt[0].c_str()), &value, 1, POD_UINT8) != POD_SUCCESS) || (value != existing))
+    {
+        std::cout << "salvaging removed an existing item\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    // Lazy items are checked when they are inflated
+
+    container = pod_alloc();
+
+    if (pod_load_file_lazy(container, fileName, checksum, checksumValue) != POD_SUCCESS)
+    {
+        std::cout << "failed to load corrupt file lazily\n";
+        return false;
+    }
+
+    const void* ptr;
+
+    if (pod_try_get_values(pod_try_get_item(container, corrupt[0].c_str()), &ptr, POD_UINT32) == POD_SUCCESS)
+    {
+        std::cout << "inflated a corrupt lazy item\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    auto src = pod_alloc();
+
+    for (size_t i = 0; i != 3; ++i)
+    {
+        if (pod_set_values(pod_get_item(src, keys[i]), values[i].data(), values[i].size(), POD_UINT32) != POD_SUCCESS)
+        {
+            std::cout << "failed to set values\n";
+            return -1;
+        }
+    }
+
+    // Block checksums need a checksum type
+
+    if (pod_save_file_ex(src, fileName, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_NONE, 0, POD_ENDIAN_NATIVE, POD_FLAGS_BLOCK_CHECKSUM) != POD_ARGUMENT_ERROR)
+    {
+        std::cout << "saved block checksums without a checksum type\n";
+        return -1;
+    }
+
+    // Files without block checksums can't be salvaged
+
+    auto container = pod_alloc();
+
+    if ((pod_save_file_ex(src, fileName, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, POD_FLAGS_INDEX) != POD_SUCCESS) ||
+        (pod_salvage_file(container, fileName, POD_CHECKSUM_CRC32, 0, nullptr, nullptr) != POD_ARGUMENT_ERROR))
+    {
+        std::cout << "salvaged a file without block checksums\n";
+        return -1;
+    }
+
+    pod_free(container);
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_ADLER32, POD_CHECKSUM_CRC32, POD_CHECKSUM_CRC32C };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_APPEND, POD_FLAGS_ALIGN };
+
+    for (uint32_t threads : { 1u, 3u })
+    {
+        pod_set_thread_count(threads);
+
+        for (auto level : levels)
+        {
+            for (auto codec : codecs)
+            {
+                for (auto checksum : checksums)
+                {
+                    for (auto endian : endians)
+                    {
+                        for (auto flag : flags)
+                        {
+                            if (!test(src, level, codec, checksum, endian, flag))
+                            {
+                                std::cout << "threads " << threads << ", level " << level << ", codec " << codec << ", checksum " << checksum << ", endian " << endian << ", flags " << flag << "\n";
+                                return -1;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Appended segments keep the checksums of the blocks they don't replace
+
+    pod_set_thread_count(2);
+
+    if (pod_save_file_ex(src, fileName, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, static_cast<pod_flags_t>(POD_FLAGS_APPEND | POD_FLAGS_BLOCK_CHECKSUM)) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return -1;
+    }
+
+    auto segment = pod_alloc();
+    std::vector<uint32_t> replaced(1000, 5);
+
+    if ((pod_set_values(pod_get_item(segment, "b"), replaced.data(), replaced.size(), POD_UINT32) != POD_SUCCESS) ||
+        (pod_append_file(segment, fileName, POD_COMPRESSION_DEFAULT, POD_CHECKSUM_CRC32, 0) != POD_SUCCESS))
+    {
+        std::cout << "failed to append file\n";
+        return -1;
+    }
+
+    values[1] = replaced;
+    container = pod_alloc();
+
+    if ((pod_salvage_file(container, fileName, POD_CHECKSUM_CRC32, 0, nullptr, nullptr) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to salvage appended file\n";
+        return -1;
+    }
+
+    pod_free(container);
+    pod_free(segment);
+    pod_free(src);
+
+    std::remove(fileName);
+
+    return 0;
+}
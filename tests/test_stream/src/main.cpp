@@ -0,0 +1,233 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+std::vector<float> f32(250007);
+std::vector<uint16_t> u16(3001);
+
+// A stream of bytes in a vector
+// reads return at most maxRead bytes, like a pipe
+struct vector_stream
+{
+    std::vector<uint8_t> bytes;
+    uint64_t pos = 0;
+    uint64_t maxRead = ~0ull;
+    uint64_t maxWrite = ~0ull;   // total bytes that can be written before writes fail
+};
+
+uint64_t POD_API stream_read(void* user, void* buffer, uint64_t size)
+{
+    auto s = static_cast<vector_stream*>(user);
+    uint64_t count = std::min({ size, s->maxRead, s->bytes.size() - s->pos });
+
+    memcpy(buffer, s->bytes.data() + s->pos, count);
+    s->pos += count;
+
+    return count;
+}
+
+uint64_t POD_API stream_write(void* user, const void* buffer, uint64_t size)
+{
+    auto s = static_cast<vector_stream*>(user);
+    uint64_t count = std::min(size, s->maxWrite - s->bytes.size());
+    auto data = static_cast<const uint8_t*>(buffer);
+
+    s->bytes.insert(s->bytes.end(), data, data + count);
+
+    return count;
+}
+
+int32_t POD_API stream_seek(void* user, uint64_t offset)
+{
+    auto s = static_cast<vector_stream*>(user);
+
+    if (offset > s->bytes.size())
+    {
+        return -1;
+    }
+
+    s->pos = offset;
+
+    return 0;
+}
+
+uint64_t POD_API stream_size(void* user)
+{
+    return static_cast<vector_stream*>(user)->bytes.size();
+}
+
+void init()
+{
+    for (size_t i = 0; i != f32.size(); ++i)
+    {
+        f32[i] = static_cast<float>(i % 613) * 1.5f;
+    }
+
+    for (size_t i = 0; i != u16.size(); ++i)
+    {
+        u16[i] = static_cast<uint16_t>(i * 7);
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    std::vector<T> copy(values.size());
+
+    return
+        (pod_try_copy_values(pod_try_get_item(container, key), copy.data(), copy.size(), type) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values.data(), values.size() * sizeof(T)) == 0);
+}
+
+bool check(pod_container_t* container)
+{
+    return
+        check_item(container, "f32", f32, POD_FLOAT32) &&
+        check_item(container, "u16", u16, POD_UINT16);
+}
+
+bool test(pod_container_t* src, pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_flags_t flags)
+{
+    vector_stream vs;
+    pod_stream_t writeStream = { nullptr, stream_write, nullptr, nullptr, &vs };
+
+    if (pod_save_stream(src, &writeStream, compression, codec, POD_CHECKSUM_CRC32, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save stream\n";
+        return false;
+    }
+
+    // The stream holds the same bytes as a buffer
+
+    void* buffer;
+    uint64_t size;
+
+    if (pod_save_memory(src, &buffer, &size, compression, codec, POD_CHECKSUM_CRC32, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save memory\n";
+        return false;
+    }
+
+    bool same = (vs.bytes.size() == size) && (memcmp(vs.bytes.data(), buffer, size) == 0);
+    pod_free_memory(buffer);
+
+    if (!same)
+    {
+        std::cout << "stream doesn't match memory\n";
+        return false;
+    }
+
+    // Load with short reads, with and without seeking
+
+    bool needsSeek = ((flags & POD_FLAGS_INDEX) != 0) || (compression == POD_COMPRESSION_0);
+
+    for (bool seekable : { false, true })
+    {
+        vs.pos = 0;
+        vs.maxRead = 1000;
+
+        pod_stream_t readStream = { stream_read, nullptr, nullptr, nullptr, &vs };
+
+        if (seekable)
+        {
+            readStream.seek = stream_seek;
+            readStream.size = stream_size;
+        }
+
+        auto container = pod_alloc();
+        pod_result_t result = pod_load_stream(container, &readStream, POD_CHECKSUM_CRC32, 0);
+
+        if (needsSeek && !seekable)
+        {
+            if (result != POD_ARGUMENT_ERROR)
+            {
+                std::cout << "loaded a file that needs seeking\n";
+                return false;
+            }
+        }
+        else if ((result != POD_SUCCESS) || !check(container))
+        {
+            std::cout << "failed to load stream\n";
+            return false;
+        }
+
+        pod_free(container);
+    }
+
+    // A failed write fails the save
+
+    vector_stream full;
+    full.maxWrite = vs.bytes.size() / 2;
+
+    pod_stream_t fullStream = { nullptr, stream_write, nullptr, nullptr, &full };
+
+    if (pod_save_stream(src, &fullStream, compression, codec, POD_CHECKSUM_CRC32, 0, endian, flags) != POD_FILE_NOT_FOUND)
+    {
+        std::cout << "saved to a stream that failed\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    auto src = pod_alloc();
+
+    if ((pod_set_values(pod_get_item(src, "f32"), f32.data(), f32.size(), POD_FLOAT32) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "u16"), u16.data(), u16.size(), POD_UINT16) != POD_SUCCESS))
+    {
+        std::cout << "failed to set values\n";
+        return -1;
+    }
+
+    // A stream without a write callback can't be saved to
+
+    pod_stream_t readOnly = { stream_read, nullptr, nullptr, nullptr, nullptr };
+
+    if (pod_save_stream(src, &readOnly, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_NONE, 0, POD_ENDIAN_NATIVE, POD_FLAGS_NONE) != POD_FILE_NOT_FOUND)
+    {
+        std::cout << "saved to a stream without a write callback\n";
+        return -1;
+    }
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_APPEND) };
+
+    for (uint32_t threads : { 1u, 2u })
+    {
+        pod_set_thread_count(threads);
+
+        for (auto level : levels)
+        {
+            for (auto codec : codecs)
+            {
+                for (auto endian : endians)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(src, level, codec, endian, flag))
+                        {
+                            std::cout << "threads " << threads << ", level " << level << ", codec " << codec << ", endian " << endian << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    pod_free(src);
+
+    return 0;
+}
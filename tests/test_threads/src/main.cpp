@@ -0,0 +1,250 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+const char* fileName = "threads_file.test.bin";
+
+// Large enough to be split into many chunks
+const size_t valueCount = 200000;
+
+bool create(pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_checksum_t checksum, pod_flags_t flags)
+{
+    std::vector<uint32_t> u32(valueCount);
+    std::vector<double> f64(valueCount);
+    const char* str = "some text";
+
+    for (size_t i = 0; i != u32.size(); ++i)
+    {
+        u32[i] = static_cast<uint32_t>((i * 2654435761u) >> 7u);
+    }
+
+    for (size_t i = 0; i != f64.size(); ++i)
+    {
+        f64[i] = static_cast<double>(i % 1000) * 0.25;
+    }
+
+    auto container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "u32"), u32.data(), u32.size(), POD_UINT32);
+    pod_set_values(pod_get_item(container, "str"), str, strlen(str), POD_UTF8_CHAR8);
+    pod_set_values(pod_get_item(container, "f64"), f64.data(), f64.size(), POD_FLOAT64);
+    pod_set_values(pod_get_item(container, "empty"), nullptr, 0, POD_INT16);
+
+    pod_result_t result = pod_save_file_ex(container, fileName, compression, codec, checksum, 0x01020304u, endian, flags);
+
+    pod_free(container);
+
+    return result == POD_SUCCESS;
+}
+
+bool check(pod_container_t* container, const char* key, bool exists)
+{
+    auto item = pod_try_get_item(container, key);
+
+    if (item == nullptr)
+    {
+        return !exists;
+    }
+
+    if (!exists)
+    {
+        return false;
+    }
+
+    uint32_t count;
+    if (pod_try_count_values(item, &count) != POD_SUCCESS)
+    {
+        return false;
+    }
+
+    if (strcmp(key, "u32") == 0)
+    {
+        std::vector<uint32_t> u32(count);
+
+        if (count != valueCount || pod_try_copy_values(item, u32.data(), count, POD_UINT32) != POD_SUCCESS)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i != u32.size(); ++i)
+        {
+            if (u32[i] != static_cast<uint32_t>((i * 2654435761u) >> 7u))
+            {
+                return false;
+            }
+        }
+    }
+    else if (strcmp(key, "f64") == 0)
+    {
+        std::vector<double> f64(count);
+
+        if (count != valueCount || pod_try_copy_values(item, f64.data(), count, POD_FLOAT64) != POD_SUCCESS)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i != f64.size(); ++i)
+        {
+            if (f64[i] != static_cast<double>(i % 1000) * 0.25)
+            {
+                return false;
+            }
+        }
+    }
+    else if (strcmp(key, "str") == 0)
+    {
+        std::vector<char> str(count);
+
+        if (count != 9 || pod_try_copy_values(item, str.data(), count, POD_UTF8_CHAR8) != POD_SUCCESS)
+        {
+            return false;
+        }
+
+        if (memcmp(str.data(), "some text", 9) != 0)
+        {
+            return false;
+        }
+    }
+    else if (strcmp(key, "empty") == 0)
+    {
+        if (count != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test(uint32_t threads, pod_compression_t compression, pod_codec_t codec, pod_endian_t endian, pod_checksum_t checksum, pod_flags_t flags)
+{
+    pod_set_thread_count(threads);
+
+    if (!create(compression, codec, endian, checksum, flags))
+    {
+        std::cout << "failed to save\n";
+        return false;
+    }
+
+    // Load everything
+
+    auto container = pod_alloc();
+
+    if (pod_load_file(container, fileName, checksum, 0x01020304u) != POD_SUCCESS)
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    if (!check(container, "u32", true) || !check(container, "f64", true) ||
+        !check(container, "str", true) || !check(container, "empty", true))
+    {
+        std::cout << "failed to validate file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if ((flags & POD_FLAGS_INDEX) == 0)
+    {
+        return true;
+    }
+
+    // Every indexed block must start at its own offset
+
+    const char* keys[] = { "f64", "str", "empty" };
+
+    container = pod_alloc();
+
+    if (pod_load_items(container, fileName, checksum, 0x01020304u, keys, 3) != POD_SUCCESS)
+    {
+        std::cout << "failed to load items\n";
+        return false;
+    }
+
+    if (!check(container, "u32", false) || !check(container, "f64", true) ||
+        !check(container, "str", true) || !check(container, "empty", true))
+    {
+        std::cout << "failed to validate items\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if (checksum == POD_CHECKSUM_NONE)
+    {
+        return true;
+    }
+
+    // A corrupt block must fail the checksum
+
+    FILE* file = fopen(fileName, "r+b");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, size / 2, SEEK_SET);
+    int c = fgetc(file);
+    fseek(file, size / 2, SEEK_SET);
+    fputc(c ^ 0x10, file);
+    fclose(file);
+
+    container = pod_alloc();
+
+    if (pod_load_file(container, fileName, checksum, 0x01020304u) == POD_SUCCESS)
+    {
+        std::cout << "loaded a corrupt file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    return true;
+}
+
+int main()
+{
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_ADLER32, POD_CHECKSUM_CRC32 };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX };
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_1, POD_COMPRESSION_DEFAULT };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const uint32_t threads[] = { 1, 2, 4, 0 };
+
+    for (auto t : threads)
+    {
+        for (auto c : checksums)
+        {
+            for (auto f : flags)
+            {
+                for (auto l : levels)
+                {
+                    for (auto e : endians)
+                    {
+                        if (!test(t, l, POD_CODEC_DEFLATE, e, c, f))
+                        {
+                            std::cout << "threads " << t << ", checksum " << c << ", flags " << f << ", level " << l << ", endian " << e << "\n";
+                            return -1;
+                        }
+                    }
+                }
+
+                for (auto e : endians)
+                {
+                    if (!test(t, POD_COMPRESSION_DEFAULT, POD_CODEC_LZ, e, c, f))
+                    {
+                        std::cout << "threads " << t << ", checksum " << c << ", flags " << f << ", codec LZ, endian " << e << "\n";
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    std::remove(fileName);
+
+    return 0;
+}
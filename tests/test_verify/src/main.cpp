@@ -0,0 +1,161 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+const char* fileName = "verify_file.test.bin";
+
+std::vector<uint8_t> read_file()
+{
+    std::vector<uint8_t> bytes;
+
+    auto file = fopen(fileName, "rb");
+    fseek(file, 0, SEEK_END);
+    bytes.resize(ftell(file));
+    fseek(file, 0, SEEK_SET);
+    bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+    fclose(file);
+
+    return bytes;
+}
+
+void write_file(const std::vector<uint8_t>& bytes, size_t size)
+{
+    auto file = fopen(fileName, "wb");
+    fwrite(bytes.data(), 1, size, file);
+    fclose(file);
+}
+
+bool test(pod_container_t* src, pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, pod_flags_t flags)
+{
+    const uint32_t checksumValue = 0x5EED;
+
+    if (pod_save_file_ex(src, fileName, compression, codec, checksum, checksumValue, POD_ENDIAN_NATIVE, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save file\n";
+        return false;
+    }
+
+    if (pod_verify_file(fileName, checksum, checksumValue) != POD_SUCCESS)
+    {
+        std::cout << "failed to verify file\n";
+        return false;
+    }
+
+    if (checksum == POD_CHECKSUM_NONE)
+    {
+        return true;
+    }
+
+    if (pod_verify_file(fileName, checksum, checksumValue + 1) != POD_FILE_CORRUPT)
+    {
+        std::cout << "verified file with the wrong checksum value\n";
+        return false;
+    }
+
+    const pod_checksum_t other = (checksum == POD_CHECKSUM_CRC32) ? POD_CHECKSUM_ADLER32 : POD_CHECKSUM_CRC32;
+
+    if (pod_verify_file(fileName, other, checksumValue) != POD_FILE_CORRUPT)
+    {
+        std::cout << "verified file with the wrong checksum type\n";
+        return false;
+    }
+
+    auto bytes = read_file();
+
+    // Flip a byte in the middle of the file
+
+    bytes[bytes.size() / 2] ^= 0x20u;
+    write_file(bytes, bytes.size());
+
+    if (pod_verify_file(fileName, checksum, checksumValue) != POD_FILE_CORRUPT)
+    {
+        std::cout << "verified a modified file\n";
+        return false;
+    }
+
+    bytes[bytes.size() / 2] ^= 0x20u;
+
+    // Truncate the file
+
+    write_file(bytes, bytes.size() - 1);
+
+    if (pod_verify_file(fileName, checksum, checksumValue) != POD_FILE_CORRUPT)
+    {
+        std::cout << "verified a truncated file\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    auto src = pod_alloc();
+
+    std::vector<uint32_t> a(100003);
+    std::vector<double> b(4099);
+
+    for (size_t i = 0; i != a.size(); ++i)
+    {
+        a[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+
+    for (size_t i = 0; i != b.size(); ++i)
+    {
+        b[i] = static_cast<double>(i) * 0.5;
+    }
+
+    if ((pod_set_values(pod_get_item(src, "a"), a.data(), a.size(), POD_UINT32) != POD_SUCCESS) ||
+        (pod_set_values(pod_get_item(src, "b"), b.data(), b.size(), POD_FLOAT64) != POD_SUCCESS))
+    {
+        std::cout << "failed to set values\n";
+        return -1;
+    }
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_ADLER32, POD_CHECKSUM_CRC32, POD_CHECKSUM_CRC32C };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX };
+
+    // A small buffer size reads the file in several chunks on a background thread
+
+    for (uint64_t bufferSize : { 0ull, 4096ull, 4ull << 20 })
+    {
+        pod_set_io_buffer_size(bufferSize);
+
+        for (auto level : levels)
+        {
+            for (auto codec : codecs)
+            {
+                for (auto checksum : checksums)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(src, level, codec, checksum, flag))
+                        {
+                            std::cout << "buffer size " << bufferSize << ", level " << level << ", codec " << codec << ", checksum " << checksum << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    pod_free(src);
+
+    std::remove(fileName);
+
+    if (pod_verify_file(fileName, POD_CHECKSUM_CRC32, 0) != POD_FILE_NOT_FOUND)
+    {
+        std::cout << "verified a missing file\n";
+        return -1;
+    }
+
+    return 0;
+}
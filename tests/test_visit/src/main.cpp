@@ -0,0 +1,267 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+const char* fileName = "visit_file.test.bin";
+
+std::vector<double> f64(100003);
+std::vector<int16_t> i16(4001);
+std::vector<uint32_t> u32(7);
+
+struct visited_item
+{
+    pod_type_t type;
+    std::vector<uint8_t> bytes;
+};
+
+// Items seen by the callback
+struct visit_state
+{
+    std::map<std::string, visited_item> items;
+    size_t calls = 0;
+    size_t stopAfter = 0;   // stop after this many items, or 0 to visit them all
+};
+
+void init()
+{
+    for (size_t i = 0; i != f64.size(); ++i)
+    {
+        f64[i] = static_cast<double>(i) * 0.25 - 7.0;
+    }
+
+    for (size_t i = 0; i != i16.size(); ++i)
+    {
+        i16[i] = static_cast<int16_t>(i * 13);
+    }
+
+    for (size_t i = 0; i != u32.size(); ++i)
+    {
+        u32[i] = static_cast<uint32_t>(0x01020304u * (i + 1));
+    }
+}
+
+pod_result_t POD_API visit(const char* key, size_t keySize, pod_type_t valueType, size_t valueCount, const void* values, void* user)
+{
+    auto& state = *static_cast<visit_state*>(user);
+
+    ++state.calls;
+
+    if ((state.stopAfter != 0) && (state.calls == state.stopAfter))
+    {
+        return POD_ARGUMENT_ERROR;
+    }
+
+    auto& item = state.items[std::string(key, keySize)];
+    item.type = valueType;
+
+    size_t size = 0;
+
+    switch (valueType)
+    {
+        case POD_FLOAT64:
+            size = valueCount * 8;
+            break;
+        case POD_INT16:
+            size = valueCount * 2;
+            break;
+        case POD_UINT32:
+            size = valueCount * 4;
+            break;
+        default:
+            break;
+    }
+
+    item.bytes.assign(static_cast<const uint8_t*>(values), static_cast<const uint8_t*>(values) + size);
+
+    return POD_SUCCESS;
+}
+
+template<class T>
+bool check_item(const visit_state& state, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    auto it = state.items.find(key);
+
+    return
+        (it != state.items.end()) &&
+        (it->second.type == type) &&
+        (it->second.bytes.size() == values.size() * sizeof(T)) &&
+        (memcmp(it->second.bytes.data(), values.data(), it->second.bytes.size()) == 0);
+}
+
+bool test(pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, pod_endian_t endian, pod_flags_t flags)
+{
+    auto container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "f64"), f64.data(), f64.size(), POD_FLOAT64);
+    pod_set_values(pod_get_item(container, "i16"), i16.data(), i16.size(), POD_INT16);
+    pod_set_filter(pod_get_item(container, "i16"), POD_FILTER_DELTA);
+
+    if (pod_save_file_ex(container, fileName, compression, codec, checksum, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to save\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    container = pod_alloc();
+
+    pod_set_values(pod_get_item(container, "u32"), u32.data(), u32.size(), POD_UINT32);
+
+    if (((flags & POD_FLAGS_APPEND) != 0) && (pod_append_file(container, fileName, compression, checksum, 0) != POD_SUCCESS))
+    {
+        std::cout << "failed to append\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    visit_state state;
+
+    if (pod_visit_file(fileName, checksum, 0, visit, &state) != POD_SUCCESS)
+    {
+        std::cout << "failed to visit\n";
+        return false;
+    }
+
+    size_t expected = ((flags & POD_FLAGS_APPEND) != 0) ? 3 : 2;
+
+    if ((state.calls != expected) || !check_item(state, "f64", f64, POD_FLOAT64) || !check_item(state, "i16", i16, POD_INT16))
+    {
+        std::cout << "visited items don't match\n";
+        return false;
+    }
+
+    if (((flags & POD_FLAGS_APPEND) != 0) && !check_item(state, "u32", u32, POD_UINT32))
+    {
+        std::cout << "appended item doesn't match\n";
+        return false;
+    }
+
+    // The result of the callback stops the visit
+
+    visit_state stopped;
+    stopped.stopAfter = 1;
+
+    if ((pod_visit_file(fileName, checksum, 0, visit, &stopped) != POD_ARGUMENT_ERROR) || (stopped.calls != 1))
+    {
+        std::cout << "failed to stop\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_ADLER32 };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_FILTER), static_cast<pod_flags_t>(POD_FLAGS_APPEND | POD_FLAGS_FILTER) };
+
+    for (auto level : levels)
+    {
+        for (auto codec : codecs)
+        {
+            for (auto checksum : checksums)
+            {
+                for (auto endian : endians)
+                {
+                    for (auto flag : flags)
+                    {
+                        if (!test(level, codec, checksum, endian, flag))
+                        {
+                            std::cout << "level " << level << ", codec " << codec << ", checksum " << checksum << ", endian " << endian << ", flags " << flag << "\n";
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // A corrupt file is reported after its items are visited
+
+    auto container = pod_alloc();
+    pod_set_values(pod_get_item(container, "u32"), u32.data(), u32.size(), POD_UINT32);
+
+    if (pod_save_file_ex(container, fileName, POD_COMPRESSION_0, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, POD_FLAGS_NONE) != POD_SUCCESS)
+    {
+        return -1;
+    }
+
+    pod_free(container);
+
+    {
+        FILE* file = fopen(fileName, "r+b");
+        fseek(file, -8, SEEK_END);
+        int byte = fgetc(file);
+        fseek(file, -8, SEEK_END);
+        fputc(byte ^ 0xFF, file);
+        fclose(file);
+    }
+
+    visit_state state;
+
+    if (pod_visit_file(fileName, POD_CHECKSUM_CRC32, 0, visit, &state) != POD_FILE_CORRUPT)
+    {
+        std::cout << "accepted a corrupt file\n";
+        return -1;
+    }
+
+    // Blocks with their own checksum are checked before they are visited,
+    // and keys may hold null characters
+
+    container = pod_alloc();
+    pod_set_values(pod_get_item_n(container, "u\0" "32", 4), u32.data(), u32.size(), POD_UINT32);
+
+    if (pod_save_file_ex(container, fileName, POD_COMPRESSION_0, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, POD_FLAGS_BLOCK_CHECKSUM) != POD_SUCCESS)
+    {
+        return -1;
+    }
+
+    pod_free(container);
+
+    state = visit_state();
+
+    if ((pod_visit_file(fileName, POD_CHECKSUM_CRC32, 0, visit, &state) != POD_SUCCESS) ||
+        (state.items.size() != 1) || (state.items.begin()->first != std::string("u\0" "32", 4)))
+    {
+        std::cout << "failed to visit a key with a null character\n";
+        return -1;
+    }
+
+    {
+        FILE* file = fopen(fileName, "r+b");
+        fseek(file, 0, SEEK_END);
+        long middle = ftell(file) / 2;
+        fseek(file, middle, SEEK_SET);
+        int byte = fgetc(file);
+        fseek(file, middle, SEEK_SET);
+        fputc(byte ^ 0xFF, file);
+        fclose(file);
+    }
+
+    state = visit_state();
+
+    if ((pod_visit_file(fileName, POD_CHECKSUM_CRC32, 0, visit, &state) != POD_FILE_CORRUPT) || (state.calls != 0))
+    {
+        std::cout << "visited a corrupt block\n";
+        return -1;
+    }
+
+    std::remove(fileName);
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+// pod-io
+// Kyle J Burgess
+
+#include "pod_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const char* fileName = "writer_file.test.bin";
+
+std::vector<float> f32(300007);
+std::vector<int64_t> i64(5003);
+std::vector<uint8_t> u8(3);
+
+void init()
+{
+    for (size_t i = 0; i != f32.size(); ++i)
+    {
+        f32[i] = static_cast<float>(i % 1013) * 0.5f;
+    }
+
+    for (size_t i = 0; i != i64.size(); ++i)
+    {
+        i64[i] = static_cast<int64_t>(i * i) - 100000;
+    }
+
+    for (size_t i = 0; i != u8.size(); ++i)
+    {
+        u8[i] = static_cast<uint8_t>(i + 7);
+    }
+}
+
+template<class T>
+bool check_item(pod_container_t* container, const char* key, const std::vector<T>& values, pod_type_t type)
+{
+    std::vector<T> copy(values.size());
+
+    return
+        (pod_try_copy_values(pod_try_get_item(container, key), copy.data(), copy.size(), type) == POD_SUCCESS) &&
+        (memcmp(copy.data(), values.data(), values.size() * sizeof(T)) == 0);
+}
+
+bool check(pod_container_t* container)
+{
+    return
+        check_item(container, "f32", f32, POD_FLOAT32) &&
+        check_item(container, "i64", i64, POD_INT64) &&
+        check_item(container, "u8", u8, POD_UINT8) &&
+        check_item(container, "empty", std::vector<uint16_t>(), POD_UINT16);
+}
+
+bool test(pod_compression_t compression, pod_codec_t codec, pod_checksum_t checksum, pod_endian_t endian, pod_flags_t flags)
+{
+    pod_writer_t* writer;
+
+    if (pod_writer_open(&writer, fileName, compression, codec, checksum, 0, endian, flags) != POD_SUCCESS)
+    {
+        std::cout << "failed to open writer\n";
+        return false;
+    }
+
+    if ((pod_writer_add_item(writer, "f32", f32.data(), f32.size(), POD_FLOAT32, POD_FILTER_SHUFFLE) != POD_SUCCESS) ||
+        (pod_writer_add_item(writer, "i64", i64.data(), i64.size(), POD_INT64, POD_FILTER_DELTA2) != POD_SUCCESS) ||
+        (pod_writer_add_item(writer, "u8", u8.data(), u8.size(), POD_UINT8, POD_FILTER_NONE) != POD_SUCCESS) ||
+        (pod_writer_add_item(writer, "empty", nullptr, 0, POD_UINT16, POD_FILTER_NONE) != POD_SUCCESS))
+    {
+        std::cout << "failed to add item\n";
+        return false;
+    }
+
+    // Keys can only be written once, and the writer is still usable afterwards
+
+    if (pod_writer_add_item(writer, "u8", u8.data(), u8.size(), POD_UINT8, POD_FILTER_NONE) != POD_ARGUMENT_ERROR)
+    {
+        std::cout << "wrote a key twice\n";
+        return false;
+    }
+
+    if (pod_writer_close(writer) != POD_SUCCESS)
+    {
+        std::cout << "failed to close writer\n";
+        return false;
+    }
+
+    auto container = pod_alloc();
+
+    if ((pod_load_file(container, fileName, checksum, 0) != POD_SUCCESS) || !check(container))
+    {
+        std::cout << "failed to load file\n";
+        return false;
+    }
+
+    pod_free(container);
+
+    if ((flags & POD_FLAGS_INDEX) != 0)
+    {
+        container = pod_alloc();
+
+        if ((pod_load_file_lazy(container, fileName, checksum, 0) != POD_SUCCESS) || !check(container))
+        {
+            std::cout << "failed to load lazily\n";
+            return false;
+        }
+
+        pod_free(container);
+    }
+
+    return true;
+}
+
+int main()
+{
+    init();
+
+    const pod_compression_t levels[] = { POD_COMPRESSION_0, POD_COMPRESSION_1, POD_COMPRESSION_DEFAULT };
+    const pod_codec_t codecs[] = { POD_CODEC_DEFLATE, POD_CODEC_LZ };
+    const pod_checksum_t checksums[] = { POD_CHECKSUM_NONE, POD_CHECKSUM_CRC32 };
+    const pod_endian_t endians[] = { POD_ENDIAN_LITTLE, POD_ENDIAN_BIG };
+    const pod_flags_t flags[] = { POD_FLAGS_NONE, POD_FLAGS_INDEX, static_cast<pod_flags_t>(POD_FLAGS_INDEX | POD_FLAGS_FILTER) };
+
+    for (uint32_t threads : { 1u, 2u })
+    {
+        pod_set_thread_count(threads);
+
+        for (auto level : levels)
+        {
+            for (auto codec : codecs)
+            {
+                for (auto checksum : checksums)
+                {
+                    for (auto endian : endians)
+                    {
+                        for (auto flag : flags)
+                        {
+                            if (!test(level, codec, checksum, endian, flag))
+                            {
+                                std::cout << "threads " << threads << ", level " << level << ", codec " << codec << ", checksum " << checksum << ", endian " << endian << ", flags " << flag << "\n";
+                                return -1;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Invalid options are rejected when the writer is opened
+
+    pod_writer_t* writer;
+
+    if (pod_writer_open(&writer, fileName, POD_COMPRESSION_DEFAULT, static_cast<pod_codec_t>(99), POD_CHECKSUM_NONE, 0, POD_ENDIAN_NATIVE, POD_FLAGS_NONE) != POD_ARGUMENT_ERROR)
+    {
+        std::cout << "opened a writer with an invalid codec\n";
+        return -1;
+    }
+
+    // Items of an unknown type are rejected
+
+    uint32_t value = 1;
+
+    if ((pod_writer_open(&writer, fileName, POD_COMPRESSION_DEFAULT, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, POD_FLAGS_INDEX) != POD_SUCCESS) ||
+        (pod_writer_add_item(writer, "unknown", &value, 1, static_cast<pod_type_t>(99), POD_FILTER_NONE) != POD_ARGUMENT_ERROR) ||
+        (pod_writer_add_item(writer, "known", &value, 1, POD_UINT32, POD_FILTER_NONE) != POD_SUCCESS) ||
+        (pod_writer_close(writer) != POD_SUCCESS))
+    {
+        std::cout << "failed to reject an item of an unknown type\n";
+        return -1;
+    }
+
+#ifdef __linux__
+    // Write errors are returned, even when the file is written behind the caller
+
+    for (uint32_t threads : { 1u, 2u })
+    {
+        pod_set_thread_count(threads);
+
+        std::vector<uint8_t> big(16u << 20, 0x5A);
+
+        if ((pod_writer_open(&writer, "/dev/full", POD_COMPRESSION_0, POD_CODEC_DEFLATE, POD_CHECKSUM_CRC32, 0, POD_ENDIAN_NATIVE, POD_FLAGS_NONE) != POD_SUCCESS))
+        {
+            continue;
+        }
+
+        pod_writer_add_item(writer, "big", big.data(), static_cast<uint32_t>(big.size()), POD_UINT8, POD_FILTER_NONE);
+
+        if (pod_writer_close(writer) != POD_FILE_NOT_FOUND)
+        {
+            std::cout << "closed a writer whose writes failed, threads " << threads << "\n";
+            return -1;
+        }
+    }
+#endif
+
+    std::remove(fileName);
+
+    return 0;
+}